@@ -35,7 +35,7 @@ PreprocessOnlySwitch   :=-E
 ObjectsFileList        :="CrossBench.txt"
 PCHCompileFlags        :=
 MakeDirCommand         :=mkdir -p
-LinkOptions            :=  -s $(shell wx-config --debug=no --libs --unicode=yes)
+LinkOptions            :=  -s
 IncludePath            :=  $(IncludeSwitch). $(IncludeSwitch)../src 
 IncludePCH             := 
 RcIncludePath          := 
@@ -50,8 +50,8 @@ LibPath                := $(LibraryPathSwitch).
 AR       := /usr/bin/ar rcu
 CXX      := /usr/bin/g++-4.8
 CC       := /usr/bin/gcc-4.8
-CXXFLAGS := -std=c++11 -O2 -Wall $(shell wx-config --cxxflags --unicode=yes --debug=no) $(Preprocessors)
-CFLAGS   :=  -O2 -Wall $(shell wx-config --cxxflags --unicode=yes --debug=no) $(Preprocessors)
+CXXFLAGS := -std=c++11 -O2 -Wall $(Preprocessors)
+CFLAGS   :=  -O2 -Wall $(Preprocessors)
 ASFLAGS  := 
 AS       := /usr/bin/as
 
@@ -60,7 +60,7 @@ AS       := /usr/bin/as
 ## User defined environment variables
 ##
 CodeLiteDir:=/usr/share/codelite
-Objects0=$(IntermediateDirectory)/main.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_crossexport.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_crossgen.cpp$(ObjectSuffix) 
+Objects0=$(IntermediateDirectory)/main.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_crossexport.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_crossgen.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_crossutils.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_crossdawg.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_crosslocal.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_crossgrid.cpp$(ObjectSuffix) $(IntermediateDirectory)/farm.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_crosstrace.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_crossanalyze.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_crossimage.cpp$(ObjectSuffix) 
 
 
 
@@ -111,6 +111,70 @@ $(IntermediateDirectory)/src_crossgen.cpp$(DependSuffix): ../src/crossgen.cpp
 $(IntermediateDirectory)/src_crossgen.cpp$(PreprocessSuffix): ../src/crossgen.cpp
 	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_crossgen.cpp$(PreprocessSuffix) "../src/crossgen.cpp"
 
+$(IntermediateDirectory)/src_crossutils.cpp$(ObjectSuffix): ../src/crossutils.cpp $(IntermediateDirectory)/src_crossutils.cpp$(DependSuffix)
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/data/Sync/SyncProjects/CrossGen/src/crossutils.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_crossutils.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_crossutils.cpp$(DependSuffix): ../src/crossutils.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_crossutils.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_crossutils.cpp$(DependSuffix) -MM "../src/crossutils.cpp"
+
+$(IntermediateDirectory)/src_crossutils.cpp$(PreprocessSuffix): ../src/crossutils.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_crossutils.cpp$(PreprocessSuffix) "../src/crossutils.cpp"
+
+$(IntermediateDirectory)/src_crossdawg.cpp$(ObjectSuffix): ../src/crossdawg.cpp $(IntermediateDirectory)/src_crossdawg.cpp$(DependSuffix)
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/data/Sync/SyncProjects/CrossGen/src/crossdawg.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_crossdawg.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_crossdawg.cpp$(DependSuffix): ../src/crossdawg.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_crossdawg.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_crossdawg.cpp$(DependSuffix) -MM "../src/crossdawg.cpp"
+
+$(IntermediateDirectory)/src_crossdawg.cpp$(PreprocessSuffix): ../src/crossdawg.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_crossdawg.cpp$(PreprocessSuffix) "../src/crossdawg.cpp"
+
+$(IntermediateDirectory)/src_crosslocal.cpp$(ObjectSuffix): ../src/crosslocal.cpp $(IntermediateDirectory)/src_crosslocal.cpp$(DependSuffix)
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/data/Sync/SyncProjects/CrossGen/src/crosslocal.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_crosslocal.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_crosslocal.cpp$(DependSuffix): ../src/crosslocal.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_crosslocal.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_crosslocal.cpp$(DependSuffix) -MM "../src/crosslocal.cpp"
+
+$(IntermediateDirectory)/src_crosslocal.cpp$(PreprocessSuffix): ../src/crosslocal.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_crosslocal.cpp$(PreprocessSuffix) "../src/crosslocal.cpp"
+
+$(IntermediateDirectory)/src_crossgrid.cpp$(ObjectSuffix): ../src/crossgrid.cpp $(IntermediateDirectory)/src_crossgrid.cpp$(DependSuffix)
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/data/Sync/SyncProjects/CrossGen/src/crossgrid.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_crossgrid.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_crossgrid.cpp$(DependSuffix): ../src/crossgrid.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_crossgrid.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_crossgrid.cpp$(DependSuffix) -MM "../src/crossgrid.cpp"
+
+$(IntermediateDirectory)/src_crossgrid.cpp$(PreprocessSuffix): ../src/crossgrid.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_crossgrid.cpp$(PreprocessSuffix) "../src/crossgrid.cpp"
+
+$(IntermediateDirectory)/farm.cpp$(ObjectSuffix): farm.cpp $(IntermediateDirectory)/farm.cpp$(DependSuffix)
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/data/Sync/SyncProjects/CrossGen/CrossBench/farm.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/farm.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/farm.cpp$(DependSuffix): farm.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/farm.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/farm.cpp$(DependSuffix) -MM "farm.cpp"
+
+$(IntermediateDirectory)/farm.cpp$(PreprocessSuffix): farm.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/farm.cpp$(PreprocessSuffix) "farm.cpp"
+
+$(IntermediateDirectory)/src_crosstrace.cpp$(ObjectSuffix): ../src/crosstrace.cpp $(IntermediateDirectory)/src_crosstrace.cpp$(DependSuffix)
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/data/Sync/SyncProjects/CrossGen/src/crosstrace.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_crosstrace.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_crosstrace.cpp$(DependSuffix): ../src/crosstrace.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_crosstrace.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_crosstrace.cpp$(DependSuffix) -MM "../src/crosstrace.cpp"
+
+$(IntermediateDirectory)/src_crosstrace.cpp$(PreprocessSuffix): ../src/crosstrace.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_crosstrace.cpp$(PreprocessSuffix) "../src/crosstrace.cpp"
+
+$(IntermediateDirectory)/src_crossanalyze.cpp$(ObjectSuffix): ../src/crossanalyze.cpp $(IntermediateDirectory)/src_crossanalyze.cpp$(DependSuffix)
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/data/Sync/SyncProjects/CrossGen/src/crossanalyze.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_crossanalyze.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_crossanalyze.cpp$(DependSuffix): ../src/crossanalyze.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_crossanalyze.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_crossanalyze.cpp$(DependSuffix) -MM "../src/crossanalyze.cpp"
+
+$(IntermediateDirectory)/src_crossanalyze.cpp$(PreprocessSuffix): ../src/crossanalyze.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_crossanalyze.cpp$(PreprocessSuffix) "../src/crossanalyze.cpp"
+
+$(IntermediateDirectory)/src_crossimage.cpp$(ObjectSuffix): ../src/crossimage.cpp $(IntermediateDirectory)/src_crossimage.cpp$(DependSuffix)
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/data/Sync/SyncProjects/CrossGen/src/crossimage.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_crossimage.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_crossimage.cpp$(DependSuffix): ../src/crossimage.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_crossimage.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_crossimage.cpp$(DependSuffix) -MM "../src/crossimage.cpp"
+
+$(IntermediateDirectory)/src_crossimage.cpp$(PreprocessSuffix): ../src/crossimage.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_crossimage.cpp$(PreprocessSuffix) "../src/crossimage.cpp"
+
 
 -include $(IntermediateDirectory)/*$(DependSuffix)
 ##
@@ -0,0 +1,241 @@
+#include "farm.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Result in pipe is this header and size items of data
+struct FarmHeader {
+    uint64_t job;
+    int64_t  time_ms;
+    uint64_t size;
+};
+
+struct FarmWorker {
+    pid_t     pid;       // -1 if it isn't running
+    int       job_fd;    // coordinator writes numbers of jobs here
+    int       result_fd; // worker writes results here
+    long long job;       // -1 if worker is idle
+    std::chrono::steady_clock::time_point start;
+};
+
+static bool writeAll(int fd, const void *buf, size_t size){
+    const char *p = static_cast<const char*>(buf);
+    while ( size > 0 ) {
+        ssize_t n = write(fd, p, size);
+        if ( (n < 0) && (errno == EINTR) )
+            continue;
+        if ( n <= 0 )
+            return false;
+        p    += n;
+        size -= n;
+    }
+    return true;
+}
+
+// Returns false on error or end of file
+static bool readAll(int fd, void *buf, size_t size){
+    char *p = static_cast<char*>(buf);
+    while ( size > 0 ) {
+        ssize_t n = read(fd, p, size);
+        if ( (n < 0) && (errno == EINTR) )
+            continue;
+        if ( n <= 0 )
+            return false;
+        p    += n;
+        size -= n;
+    }
+    return true;
+}
+
+// Loop of worker process, it ends when coordinator closes pipe of jobs
+static void procWorker(int job_fd, int result_fd, const FarmJob &job){
+    uint64_t job_ind;
+    std::vector< uint64_t > data;
+    while ( readAll(job_fd, &job_ind, sizeof(job_ind)) ) {
+        data.clear();
+        auto start = std::chrono::steady_clock::now();
+        job(static_cast<size_t>(job_ind), data);
+        FarmHeader header;
+        header.job     = job_ind;
+        header.time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        header.size    = data.size();
+        if ( !writeAll(result_fd, &header, sizeof(header)) ||
+             !writeAll(result_fd, data.data(), data.size() * sizeof(uint64_t)) )
+            break;
+    }
+}
+
+static bool startWorker(std::vector<FarmWorker> &workers, size_t ind, const FarmJob &job){
+    int job_pipe[2], result_pipe[2];
+    if ( pipe(job_pipe) != 0 )
+        return false;
+    if ( pipe(result_pipe) != 0 ) {
+        close(job_pipe[0]);
+        close(job_pipe[1]);
+        return false;
+    }
+    // Else buffered output of coordinator is written by child too
+    std::fflush(stdout);
+    std::fflush(stderr);
+    pid_t pid = fork();
+    if ( pid < 0 ) {
+        close(job_pipe[0]);
+        close(job_pipe[1]);
+        close(result_pipe[0]);
+        close(result_pipe[1]);
+        return false;
+    }
+    if ( pid == 0 ) {
+        // Child has copies of pipes of other workers, they wouldn't get end
+        // of file while these copies are open
+        for (size_t i = 0; i < workers.size(); ++i)
+            if ( (i != ind) && (workers[i].pid > 0) ) {
+                close(workers[i].job_fd);
+                close(workers[i].result_fd);
+            }
+        close(job_pipe[1]);
+        close(result_pipe[0]);
+        procWorker(job_pipe[0], result_pipe[1], job);
+        // Destructors and atexit handlers belong to coordinator
+        _exit(0);
+    }
+    close(job_pipe[0]);
+    close(result_pipe[1]);
+    FarmWorker &w = workers[ind];
+    w.pid       = pid;
+    w.job_fd    = job_pipe[1];
+    w.result_fd = result_pipe[0];
+    w.job       = -1;
+    return true;
+}
+
+// Idle worker exits by end of file in pipe of jobs, busy one is killed
+static void stopWorker(FarmWorker &w){
+    close(w.job_fd);
+    close(w.result_fd);
+    if ( w.job >= 0 )
+        kill(w.pid, SIGKILL);
+    waitpid(w.pid, nullptr, 0);
+    w.pid = -1;
+    w.job = -1;
+}
+
+bool runFarm(size_t count, size_t workers, long long timeout_ms, const FarmJob &job,
+    std::vector<FarmResult> &results_out, size_t *restarts_out){
+    results_out.assign(count, FarmResult());
+    if ( restarts_out != nullptr )
+        *restarts_out = 0;
+    workers = std::min(workers, count);
+    if ( workers == 0 )
+        return count == 0;
+
+    // Writing to pipe of died worker must not kill coordinator
+    void (*old_sigpipe)(int) = signal(SIGPIPE, SIG_IGN);
+    FarmWorker idle_worker = {-1, -1, -1, -1, std::chrono::steady_clock::time_point()};
+    std::vector< FarmWorker > ws(workers, idle_worker);
+    bool ok = true;
+    for (size_t i = 0; (i < ws.size()) && ok; ++i)
+        ok = startWorker(ws, i, job);
+
+    size_t next_job = 0, finished = 0;
+    std::vector< pollfd > fds;
+    std::vector< size_t > fd_workers;
+    while ( ok && (finished < count) ) {
+        // Idle workers get next jobs
+        for (size_t i = 0; (i < ws.size()) && (next_job < count); ++i) {
+            FarmWorker &w = ws[i];
+            if ( (w.pid <= 0) || (w.job >= 0) )
+                continue;
+            uint64_t job_ind = next_job;
+            if ( !writeAll(w.job_fd, &job_ind, sizeof(job_ind)) ) {
+                // Worker died without job, it is replaced and job waits
+                stopWorker(w);
+                if ( restarts_out != nullptr )
+                    ++*restarts_out;
+                ok = startWorker(ws, i, job);
+                break;
+            }
+            w.job   = static_cast<long long>(next_job++);
+            w.start = std::chrono::steady_clock::now();
+        }
+        if ( !ok )
+            break;
+
+        // Results are waited up to the nearest deadline
+        auto now = std::chrono::steady_clock::now();
+        int wait_ms = -1;
+        fds.clear();
+        fd_workers.clear();
+        for (size_t i = 0; i < ws.size(); ++i) {
+            if ( ws[i].job < 0 )
+                continue;
+            pollfd pfd = {ws[i].result_fd, POLLIN, 0};
+            fds.push_back(pfd);
+            fd_workers.push_back(i);
+            if ( timeout_ms > 0 ) {
+                long long left = timeout_ms - std::chrono::duration_cast<std::chrono::milliseconds>(
+                    now - ws[i].start).count();
+                int left_ms = static_cast<int>(std::max(left, 0LL));
+                wait_ms = wait_ms < 0 ? left_ms : std::min(wait_ms, left_ms);
+            }
+        }
+        if ( fds.empty() )
+            continue;
+        if ( (poll(fds.data(), fds.size(), wait_ms) < 0) && (errno != EINTR) ) {
+            ok = false;
+            break;
+        }
+
+        now = std::chrono::steady_clock::now();
+        for (size_t k = 0; (k < fds.size()) && ok; ++k) {
+            size_t      ind = fd_workers[k];
+            FarmWorker &w   = ws[ind];
+            FarmResult &res = results_out[w.job];
+            long long   spent_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                now - w.start).count();
+            if ( fds[k].revents != 0 ) {
+                FarmHeader header;
+                if ( readAll(w.result_fd, &header, sizeof(header)) &&
+                     (header.job == static_cast<uint64_t>(w.job)) ) {
+                    res.data.resize(header.size);
+                    if ( readAll(w.result_fd, res.data.data(), res.data.size() * sizeof(uint64_t)) ) {
+                        res.status  = FarmStatus::Done;
+                        res.time_ms = header.time_ms;
+                        w.job = -1;
+                        ++finished;
+                        continue;
+                    }
+                }
+                res.data.clear();
+                res.status  = FarmStatus::Crashed;
+                res.time_ms = spent_ms;
+            } else if ( (timeout_ms > 0) && (spent_ms >= timeout_ms) ) {
+                res.status  = FarmStatus::Timeout;
+                res.time_ms = spent_ms;
+            } else {
+                continue;
+            }
+            ++finished;
+            stopWorker(w);
+            if ( next_job < count ) {
+                ok = startWorker(ws, ind, job);
+                if ( restarts_out != nullptr )
+                    ++*restarts_out;
+            }
+        }
+    }
+    for (auto &w: ws)
+        if ( w.pid > 0 )
+            stopWorker(w);
+    signal(SIGPIPE, old_sigpipe);
+    return ok;
+}
@@ -0,0 +1,38 @@
+#ifndef FARM_HPP
+#define FARM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Generation in worker processes for big batches, so one pathological grid
+// or crash can't stop the whole run. It is POSIX only
+
+enum class FarmStatus {
+    Done,    // job is finished by worker
+    Timeout, // worker is killed by deadline
+    Crashed  // worker died during job
+};
+
+struct FarmResult {
+    FarmStatus              status;
+    long long               time_ms; // time of job in worker or timeout
+    std::vector< uint64_t > data;    // made by job, empty if it isn't done
+
+    FarmResult(): status(FarmStatus::Crashed), time_ms(0) {}
+};
+
+// Runs in worker process and fills data_out for job number job
+typedef std::function< void(size_t job, std::vector<uint64_t> &data_out) > FarmJob;
+
+// Coordinator: forks workers processes and hands jobs [0, count) to them over
+// pipes, results_out is in order of jobs. Everything loaded before the call
+// (dictionary, grids) is shared with workers by copy-on-write pages of fork,
+// so it is loaded once. Worker which doesn't finish job in timeout_ms (0 is
+// no limit) is killed, new worker is started after timeout or crash and
+// restarts_out gets their number. Returns false if worker can't be started
+bool runFarm(size_t count, size_t workers, long long timeout_ms, const FarmJob &job,
+    std::vector<FarmResult> &results_out, size_t *restarts_out = nullptr);
+
+#endif // FARM_HPP
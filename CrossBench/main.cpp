@@ -1,94 +1,615 @@
-#include "wx/wx.h"
-
-#include <wx/app.h>
-#include <wx/cmdline.h>
-
-#include "crossbasetypes.hpp"
-#include "crossgen.hpp"
-
-/* To-Do:
- * Console app that runs generating of crosswords
- * with random or not. And if yes with command-line parametrs we can
- * set number of tests and get
- * 3. Dispersion
- */
-
-static const wxCmdLineEntryDesc cmdLineDesc[] = {
-    { wxCMD_LINE_PARAM , wxT(""), wxT(""), wxT("grid_path"), 
-        wxCMD_LINE_VAL_STRING },
-    { wxCMD_LINE_PARAM, wxT(""), wxT(""), wxT("dict_path"),
-        wxCMD_LINE_VAL_STRING },
-    { wxCMD_LINE_OPTION, wxT("c"), wxT("count"), wxT("times to run generation, default = 10"),
-        wxCMD_LINE_VAL_NUMBER },
-    { wxCMD_LINE_SWITCH, wxT("r"), wxT("rand"), wxT("enables generating random crosswords"),
-        wxCMD_LINE_VAL_NONE },
-    { wxCMD_LINE_SWITCH, wxT("v"), wxT("verbose"), wxT("enables verbose mode"),
-        wxCMD_LINE_VAL_NONE },
-    { wxCMD_LINE_SWITCH, wxT("h"), wxT("help"), wxT("show this help message"),
-        wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
-    { wxCMD_LINE_NONE }
-};
-
-int main(int argc, char **argv) {
-    wxInitializer wx_initializer;
-    if ( !wx_initializer ) {
-        fprintf(stderr, "Failed to initialize the wxWidgets library, aborting.");
-        return -1;
-    }
-    wxCmdLineParser cmd_parser(cmdLineDesc, argc, argv);
-    
-    long run_count = 10;
-    wxString grid_path, dict_path;
-    
-    bool is_rand    = false;
-    bool is_verbose = false;
-    
-    switch ( cmd_parser.Parse() ) {
-        case -1:
-            return 0;
-        case 0:
-            cmd_parser.Found(wxT("count"), &run_count);
-            is_rand    = cmd_parser.Found(wxT("rand"));
-            is_verbose = cmd_parser.Found(wxT("verbose"));
-            grid_path  = cmd_parser.GetParam(0);
-            dict_path  = cmd_parser.GetParam(1);
-            wxLogDebug(wxT("grid_path = ") + grid_path + wxT("\n"));
-            wxLogDebug(wxT("dict_path = ") + dict_path + wxT("\n"));
-            wxLogDebug(wxT("run_count = %d\n"), run_count);
-            break;
-        default:
-            return 0;
-    }
-    std::vector< wxLongLong > durs(run_count); // durations
-    std::vector< wxString > words_out;
-    DictType dict;
-    GridType grid;
-    AllWordsType all_words;
-    CharsTransType trans_type;
-    
-    readDict(dict_path, dict);
-    generateAllWords(dict, all_words, trans_type);
-    readGrid(grid_path, grid);
-    
-    if ( is_rand )
-        srand(time(NULL));
-    
-    for (long i = 0; i < run_count; ++i) {
-        if ( !is_rand )
-            srand(42);
-        words_out.clear();
-        durs.at(i) = wxGetLocalTimeMillis();
-        generateCross(grid,all_words,trans_type,words_out);
-        if ( words_out.size() == 0 )
-            wxPrintf(wxT("Error in creating #%-2i!\n"),i+1);
-        durs.at(i) = wxGetLocalTimeMillis() - durs.at(i);
-        if ( is_verbose )
-            wxPrintf(wxT("Time to generate  #%-2i is ") 
-                + durs.at(i).ToString() + wxT(" ms\n"), i+1);
-    }
-    wxLongLong tm_total = std::accumulate(durs.begin(),durs.end(), wxLongLong(0,0));
-    wxLongLong tm_mean  = (tm_total + run_count/2) / run_count;
-    wxPrintf(wxT("Total time = ") + tm_total.ToString() + wxT(" ms.\nMean time  = ") 
-        + tm_mean.ToString() + wxT(" ms.\n"));
-    return 0;
-}
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "crossanalyze.hpp"
+#include "crossbasetypes.hpp"
+#include "crossexport.hpp"
+#include "crossgen.hpp"
+#include "crosstrace.hpp"
+#include "farm.hpp"
+
+/* To-Do:
+ * Console app that runs generating of crosswords
+ * with random or not. And if yes with command-line parametrs we can
+ * set number of tests and get
+ * 3. Dispersion
+ */
+
+// Allocations of process are counted to show memory traffic of generation
+static std::atomic< unsigned long long > alloc_count(0);
+static std::atomic< unsigned long long > alloc_bytes(0);
+
+// The whole family of global new and delete is replaced, so every block
+// from countedAlloc is freed by std::free whichever form of delete is used
+static void* countedAlloc(std::size_t size) noexcept{
+    ++alloc_count;
+    alloc_bytes += size;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new(std::size_t size){
+    void *p = countedAlloc(size);
+    if ( p == nullptr )
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t size){
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept{
+    return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept{
+    return countedAlloc(size);
+}
+
+// Deletes are inlined to callers where new isn't, and GCC warns that free
+// gets pointer of operator new though both are replaced here
+#if defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 11)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void *p) noexcept{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept{
+    std::free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t&) noexcept{
+    std::free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t&) noexcept{
+    std::free(p);
+}
+
+#if defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 11)
+#pragma GCC diagnostic pop
+#endif
+
+// Seconds between checkpoints of search
+static const long long CHECKPOINT_INTERVAL_S = 10;
+
+// Generation which is stopped by SIGINT and SIGTERM, its state is saved then
+static GenerateControl *interrupted_ctrl = nullptr;
+
+static void onInterrupt(int){
+    if ( interrupted_ctrl != nullptr )
+        interrupted_ctrl->cancel = true;
+}
+
+static void printUsage(const char *app){
+    std::printf("Usage: %s [-c <num>] [-r] [-d] [-u <delta>] [-g <num>] [-b <ms>] [-e <engine>] [-l <num>] [-j <num> [-t <ms>]] [-T <file>] [-k <file>] [-a] [-v] [-o <file> [-f <format>]] [-i <prefix>] [-h] grid_path... dict_path\n", app);
+    std::printf("       %s -p <file> grid_path...\n", app);
+    std::printf("  grid_path is grid or packed file of grids, every run takes the next grid\n");
+    std::printf("  -c, --count=<num>  times to run generation, default = 10\n");
+    std::printf("  -o, --output=<file> export all generated crosswords to file\n");
+    std::printf("  -f, --format=<fmt> format of export: text, json, svg or png, default = text\n");
+    std::printf("  -i, --images=<prefix> draws every crossword to its own file <prefix><num>.png\n");
+    std::printf("                     (.svg with -f svg) in threads, one per core or <num> of -j\n");
+    std::printf("  --cell=<px>        side of cell in svg and png images, default = 32\n");
+    std::printf("  --blank            svg and png images are drawn without answers\n");
+    std::printf("  -r, --rand         enables generating random crosswords\n");
+    std::printf("  -d, --dawg         builds automatons of words and uses them in solver\n");
+    std::printf("  -u, --update=<file> applies delta file to dictionary before generation\n");
+    std::printf("  -g, --regen=<num>  after every generation solves again <num> random slots\n");
+    std::printf("  -b, --best=<ms>    searches for the best crossword during <ms> and prints\n");
+    std::printf("                     quality-vs-time curve\n");
+    std::printf("  -e, --engine=<name> solver: backtracking or local, default = backtracking\n");
+    std::printf("  -l, --lookahead=<num> with -d tries <num> first candidates of slot in order\n");
+    std::printf("                     of options they leave to crossing slots\n");
+    std::printf("  -j, --jobs=<num>   generates in <num> worker processes\n");
+    std::printf("  -t, --timeout=<ms> with -j kills worker generating one crossword longer\n");
+    std::printf("                     than <ms> and starts new one\n");
+    std::printf("  -T, --trace=<file> writes timeline of phases to file in Chrome trace format,\n");
+    std::printf("                     worker processes of -j aren't traced\n");
+    std::printf("  -k, --checkpoint=<file> saves state of backtracking to file every %lld s and\n",
+        CHECKPOINT_INTERVAL_S);
+    std::printf("                     on SIGINT or SIGTERM, the first run resumes it from file\n");
+    std::printf("  -a, --analyze      prints compatibility of every grid with dictionary and\n");
+    std::printf("                     estimated difficulty and exits\n");
+    std::printf("  -p, --pack=<file>  packs all grids to one file for batch runs and exits\n");
+    std::printf("  -v, --verbose      enables verbose mode\n");
+    std::printf("  -h, --help         show this help message\n");
+}
+
+template <class TChar>
+static void printDawgsStatsT(const WordsStorageT<TChar> &words, const WordsDawgsT<TChar> &dawgs){
+    size_t flat_total = 0, dawg_total = 0;
+    for (size_t i = 1; i < dawgs.size(); ++i) {
+        if ( words.at(i).empty() )
+            continue;
+        // Automatons don't replace words, they are kept besides them. Every
+        // word is vector, so its header and heap block are counted too
+        size_t flat = words.at(i).size() * (sizeof(TransedWordT<TChar>) + i * sizeof(TChar));
+        std::printf("Length %2zu: %7zu words, %7zu nodes, %9zu bytes added to %9zu bytes of words\n",
+            i, words.at(i).size(), dawgs.at(i).nodesCount(), dawgs.at(i).memoryUsage(), flat);
+        flat_total += flat;
+        dawg_total += dawgs.at(i).memoryUsage();
+    }
+    std::printf("Total: %zu bytes of automatons added to %zu bytes of words\n", dawg_total, flat_total);
+}
+
+static void printDawgsStats(const AllWordsType &words){
+    if ( words.wide )
+        printDawgsStatsT(words.wide_words, words.wide_dawgs);
+    else
+        printDawgsStatsT(words.narrow_words, words.narrow_dawgs);
+}
+
+static void printAnalysis(size_t num, const GridAnalysis &a, long long time_us, bool is_verbose){
+    std::printf("Grid #%-2zu is %s: %zu slots, %zu crossings, density %.2f, analysed in %lld us\n",
+        num, getDifficultyName(a.difficulty), a.domains.size(), a.crossings, a.crossing_density, time_us);
+    for (size_t len = 1; len < a.slots_by_len.size(); ++len)
+        if ( a.slots_by_len[len] > 0 )
+            std::printf("  Length %2zu: %4zu slots, %7zu words\n", len, a.slots_by_len[len], a.words_by_len[len]);
+    size_t min_slot = 0;
+    for (size_t i = 0; i < a.domains.size(); ++i) {
+        if ( a.domains[i] < a.domains[min_slot] )
+            min_slot = i;
+        if ( is_verbose )
+            std::printf("  Slot %3zu: %7zu candidates\n", i, a.domains[i]);
+    }
+    if ( !a.domains.empty() )
+        std::printf("  The least candidates: %zu in slot %zu\n", a.domains[min_slot], min_slot);
+    if ( a.difficulty != GridDifficulty::Hopeless )
+        std::printf("  log10 of space = %.1f, of expected fills = %.1f, constrainedness = %.2f\n",
+            a.log_space, a.log_fills, a.constrainedness);
+}
+
+int main(int argc, char **argv) {
+    long run_count = 10;
+    long regen_count = 0;
+    long jobs = 0;
+    long lookahead = 0;
+    long long best_ms = 0;
+    long long timeout_ms = 0;
+    std::string dict_path, out_path, delta_path, pack_path, trace_path, images_prefix;
+    std::string checkpoint_path;
+    ExportFormat out_format = ExportFormat::Text;
+    ImageOptions image_opts;
+    SolverEngine engine     = SolverEngine::Backtracking;
+
+    bool is_rand    = false;
+    bool is_verbose = false;
+    bool use_dawg   = false;
+    bool is_analyze = false;
+
+    std::vector< std::string > params;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ( (arg == "-h") || (arg == "--help") ) {
+            printUsage(argv[0]);
+            return 0;
+        } else if ( (arg == "-r") || (arg == "--rand") ) {
+            is_rand = true;
+        } else if ( (arg == "-d") || (arg == "--dawg") ) {
+            use_dawg = true;
+        } else if ( (arg == "-a") || (arg == "--analyze") ) {
+            is_analyze = true;
+        } else if ( arg == "--blank" ) {
+            image_opts.show_answers = false;
+        } else if ( arg.compare(0, 7, "--cell=") == 0 ) {
+            image_opts.cell_size = std::atoi(arg.c_str() + 7);
+        } else if ( (arg == "-v") || (arg == "--verbose") ) {
+            is_verbose = true;
+        } else if ( (arg == "-c") && (i + 1 < argc) ) {
+            run_count = std::atol(argv[++i]);
+        } else if ( arg.compare(0, 8, "--count=") == 0 ) {
+            run_count = std::atol(arg.c_str() + 8);
+        } else if ( (arg == "-g") && (i + 1 < argc) ) {
+            regen_count = std::atol(argv[++i]);
+        } else if ( arg.compare(0, 8, "--regen=") == 0 ) {
+            regen_count = std::atol(arg.c_str() + 8);
+        } else if ( (arg == "-b") && (i + 1 < argc) ) {
+            best_ms = std::atoll(argv[++i]);
+        } else if ( arg.compare(0, 7, "--best=") == 0 ) {
+            best_ms = std::atoll(arg.c_str() + 7);
+        } else if ( (arg == "-l") && (i + 1 < argc) ) {
+            lookahead = std::atol(argv[++i]);
+        } else if ( arg.compare(0, 12, "--lookahead=") == 0 ) {
+            lookahead = std::atol(arg.c_str() + 12);
+        } else if ( (arg == "-j") && (i + 1 < argc) ) {
+            jobs = std::atol(argv[++i]);
+        } else if ( arg.compare(0, 7, "--jobs=") == 0 ) {
+            jobs = std::atol(arg.c_str() + 7);
+        } else if ( (arg == "-t") && (i + 1 < argc) ) {
+            timeout_ms = std::atoll(argv[++i]);
+        } else if ( arg.compare(0, 10, "--timeout=") == 0 ) {
+            timeout_ms = std::atoll(arg.c_str() + 10);
+        } else if ( (arg == "-T") && (i + 1 < argc) ) {
+            trace_path = argv[++i];
+        } else if ( arg.compare(0, 8, "--trace=") == 0 ) {
+            trace_path = arg.substr(8);
+        } else if ( (arg == "-k") && (i + 1 < argc) ) {
+            checkpoint_path = argv[++i];
+        } else if ( arg.compare(0, 13, "--checkpoint=") == 0 ) {
+            checkpoint_path = arg.substr(13);
+        } else if ( (arg == "-p") && (i + 1 < argc) ) {
+            pack_path = argv[++i];
+        } else if ( arg.compare(0, 7, "--pack=") == 0 ) {
+            pack_path = arg.substr(7);
+        } else if ( (arg == "-u") && (i + 1 < argc) ) {
+            delta_path = argv[++i];
+        } else if ( arg.compare(0, 9, "--update=") == 0 ) {
+            delta_path = arg.substr(9);
+        } else if ( (arg == "-o") && (i + 1 < argc) ) {
+            out_path = argv[++i];
+        } else if ( arg.compare(0, 9, "--output=") == 0 ) {
+            out_path = arg.substr(9);
+        } else if ( (arg == "-i") && (i + 1 < argc) ) {
+            images_prefix = argv[++i];
+        } else if ( arg.compare(0, 9, "--images=") == 0 ) {
+            images_prefix = arg.substr(9);
+        } else if ( ((arg == "-f") && (i + 1 < argc)) || (arg.compare(0, 9, "--format=") == 0) ) {
+            std::string name = arg == "-f" ? argv[++i] : arg.substr(9);
+            if ( !parseExportFormat(name, out_format) ) {
+                std::fprintf(stderr, "Unknown format '%s'\n", name.c_str());
+                printUsage(argv[0]);
+                return 0;
+            }
+        } else if ( ((arg == "-e") && (i + 1 < argc)) || (arg.compare(0, 9, "--engine=") == 0) ) {
+            std::string name = arg == "-e" ? argv[++i] : arg.substr(9);
+            if ( !parseSolverEngine(name, engine) ) {
+                std::fprintf(stderr, "Unknown engine '%s'\n", name.c_str());
+                printUsage(argv[0]);
+                return 0;
+            }
+        } else if ( (arg.size() > 1) && (arg[0] == '-') ) {
+            std::fprintf(stderr, "Unknown option '%s'\n", arg.c_str());
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            params.push_back(arg);
+        }
+    }
+    size_t min_params = pack_path.empty() ? 2 : 1;
+    if ( (params.size() < min_params) || (run_count <= 0) || (regen_count < 0) || (best_ms < 0) ||
+         (jobs < 0) || (timeout_ms < 0) || (lookahead < 0) ||
+         (image_opts.cell_size < 8) ) {
+        printUsage(argv[0]);
+        return 0;
+    }
+    if ( (jobs > 0) && (regen_count > 0) ) {
+        std::fprintf(stderr, "Regeneration isn't supported by worker processes\n");
+        return 0;
+    }
+    if ( !checkpoint_path.empty() &&
+         ((jobs > 0) || (best_ms > 0) || (engine != SolverEngine::Backtracking)) ) {
+        std::fprintf(stderr, "Checkpoints are supported only by backtracking in this process\n");
+        return 0;
+    }
+    if ( pack_path.empty() ) {
+        dict_path = params.back();
+        params.pop_back();
+    }
+    bool is_export = !out_path.empty() || !images_prefix.empty();
+    crossLogDebug("dict_path = %s", dict_path.c_str());
+    crossLogDebug("run_count = %ld", run_count);
+    if ( !trace_path.empty() ) {
+        enableTrace(true);
+        setTraceThreadName("main");
+    }
+
+    std::vector< long long > durs(run_count); // durations in ms
+    std::vector< long long > regen_durs;      // durations in us
+    std::vector< long long > fill_scores;
+    unsigned long long gen_allocs = 0, gen_bytes = 0;
+    std::vector< WordUniq > ids_out;
+    std::vector< FilledCrossword > crosses;
+    std::vector< CompiledGrid > cgrids;
+    PreparedDict dict;
+
+    auto grids_start = std::chrono::steady_clock::now();
+    for (auto &grid_path: params) {
+        std::vector< CompiledGrid > packed;
+        if ( readPackedGrids(grid_path, packed) ) {
+            for (auto &cgrid: packed)
+                cgrids.push_back(std::move(cgrid));
+            continue;
+        }
+        cgrids.push_back(CompiledGrid());
+        if ( !readGrid(grid_path, cgrids.back()) ) {
+            std::fprintf(stderr, "Cannot read grid %s\n", grid_path.c_str());
+            return -1;
+        }
+    }
+    if ( is_verbose || (cgrids.size() > 1) )
+        std::printf("%zu grids are read in %lld ms.\n", cgrids.size(), static_cast<long long>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - grids_start).count()));
+    if ( !pack_path.empty() ) {
+        std::vector< GridType > grids;
+        for (auto &cgrid: cgrids)
+            grids.push_back(cgrid.grid);
+        if ( !writePackedGrids(pack_path, grids) ) {
+            std::fprintf(stderr, "Cannot write packed grids to %s\n", pack_path.c_str());
+            return -1;
+        }
+        return 0;
+    }
+    // Only lengths of slots of grids are prepared
+    auto dict_start = std::chrono::steady_clock::now();
+    if ( !loadDict(dict_path, dict, true) ) {
+        std::fprintf(stderr, "Cannot read dictionary %s\n", dict_path.c_str());
+        return -1;
+    }
+    auto prepare_start = std::chrono::steady_clock::now();
+    for (auto &cgrid: cgrids)
+        prepareDictLengths(dict, cgrid);
+    if ( is_verbose )
+        std::printf("Dictionary is read in %lld ms, lengths of grids are prepared in %lld ms.\n",
+            static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                prepare_start - dict_start).count()),
+            static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - prepare_start).count()));
+    if ( !delta_path.empty() ) {
+        auto start = std::chrono::steady_clock::now();
+        PreparedDict updated;
+        if ( !applyDictDelta(dict, delta_path, updated) ) {
+            std::fprintf(stderr, "Cannot read delta %s\n", delta_path.c_str());
+            return -1;
+        }
+        dict = std::move(updated);
+        std::printf("Delta is applied in %lld ms.\n", static_cast<long long>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count()));
+    }
+    if ( is_analyze ) {
+        GridAnalysis analysis;
+        for (size_t i = 0; i < cgrids.size(); ++i) {
+            auto start = std::chrono::steady_clock::now();
+            analyzeGrid(cgrids[i], dict.words, analysis);
+            long long time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            printAnalysis(i + 1, analysis, time_us, is_verbose);
+        }
+        if ( !trace_path.empty() && !writeTrace(trace_path) ) {
+            std::fprintf(stderr, "Cannot write trace to %s\n", trace_path.c_str());
+            return -1;
+        }
+        return 0;
+    }
+    if ( use_dawg ) {
+        auto start = std::chrono::steady_clock::now();
+        buildWordsDawgs(dict.words);
+        std::printf("Automatons are built in %lld ms.\n", static_cast<long long>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count()));
+        if ( is_verbose )
+            printDawgsStats(dict.words);
+    }
+    GenerateContext gen_ctx(dict.words, dict.trans);
+    GenerateControl gen_ctrl;
+    gen_ctrl.lookahead = static_cast<size_t>(lookahead);
+    unsigned long long gen_nodes = 0;
+
+    SearchCheckpoint checkpoint;
+    if ( !checkpoint_path.empty() ) {
+        if ( readSearchCheckpoint(checkpoint_path, checkpoint) ) {
+            if ( checkpoint.key == getSearchKey(cgrids[0], dict.words, gen_ctrl.lookahead) ) {
+                gen_ctrl.resume = &checkpoint;
+                std::printf("Search is resumed from %s: %zu slots are filled, %llu nodes.\n",
+                    checkpoint_path.c_str(), checkpoint.frames.size(),
+                    static_cast<unsigned long long>(checkpoint.nodes));
+            } else {
+                std::printf("Checkpoint %s is for other grid, dictionary or options, it is ignored.\n",
+                    checkpoint_path.c_str());
+            }
+        }
+        auto last_save = std::chrono::steady_clock::now();
+        gen_ctrl.on_checkpoint = [&](const SearchCheckpoint &cp) {
+            auto now = std::chrono::steady_clock::now();
+            if ( !gen_ctrl.cancel && (now - last_save < std::chrono::seconds(CHECKPOINT_INTERVAL_S)) )
+                return;
+            last_save = now;
+            if ( !writeSearchCheckpoint(checkpoint_path, cp) )
+                std::fprintf(stderr, "Cannot write checkpoint to %s\n", checkpoint_path.c_str());
+        };
+        interrupted_ctrl = &gen_ctrl;
+        std::signal(SIGINT, onInterrupt);
+        std::signal(SIGTERM, onInterrupt);
+    }
+
+    if ( is_rand )
+        srand(time(NULL));
+
+    if ( jobs > 0 ) {
+        // Every job gets the same seed as run in this process, random jobs
+        // get different seeds
+        unsigned rand_seed = static_cast<unsigned>(time(NULL));
+        FarmJob job = [&](size_t i, std::vector<uint64_t> &data_out) {
+            srand(is_rand ? rand_seed + static_cast<unsigned>(i) : 42);
+            const CompiledGrid &cgrid = cgrids[i % cgrids.size()];
+            if ( best_ms > 0 )
+                gen_ctx.generateBest(cgrid, best_ms, ids_out);
+            else if ( engine == SolverEngine::Backtracking )
+                gen_ctx.generate(cgrid, ids_out, &gen_ctrl);
+            else
+                generateCrossIds(cgrid, dict.words, engine, ids_out);
+            // Clues are chosen by worker to keep order of rand() calls
+            data_out.assign(ids_out.begin(), ids_out.end());
+            for (auto id: ids_out)
+                data_out.push_back(getRandClueIndex(dict.clues, id));
+        };
+        std::vector< FarmResult > results;
+        size_t restarts = 0;
+        auto start = std::chrono::steady_clock::now();
+        TraceScope trace("runFarm");
+        if ( !runFarm(run_count, jobs, timeout_ms, job, results, &restarts) ) {
+            std::fprintf(stderr, "Cannot run worker processes\n");
+            return -1;
+        }
+        std::printf("Farm time = %lld ms with %ld workers, %zu restarts.\n", static_cast<long long>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count()), jobs, restarts);
+        for (long i = 0; i < run_count; ++i) {
+            const FarmResult &res = results[i];
+            durs.at(i) = res.time_ms;
+            if ( res.status == FarmStatus::Timeout )
+                std::printf("Timeout in creating #%-2li!\n", i+1);
+            else if ( res.status == FarmStatus::Crashed )
+                std::printf("Crash in creating #%-2li!\n", i+1);
+            else if ( res.data.empty() )
+                std::printf("Error in creating #%-2li!\n", i+1);
+            if ( is_verbose )
+                std::printf("Time to generate  #%-2li is %lld ms\n", i+1, durs.at(i));
+            if ( res.data.empty() )
+                continue;
+            size_t words_count = res.data.size() / 2;
+            ids_out.assign(res.data.begin(), res.data.begin() + words_count);
+            fill_scores.push_back(getCrossScore(dict.words, ids_out));
+            if ( !is_export )
+                continue;
+            const CompiledGrid &cgrid = cgrids[i % cgrids.size()];
+            crosses.push_back(FilledCrossword());
+            FilledCrossword &cross = crosses.back();
+            cross.grid  = cgrid.grid;
+            cross.words = cgrid.winfos;
+            gen_ctx.getWords(ids_out, cross.ans);
+            for (size_t k = 0; k < words_count; ++k)
+                cross.ques.push_back(dict.clues.text->get(
+                    dict.clues.clues.at(getUniqLen(ids_out[k]))[res.data[words_count + k]]));
+        }
+    }
+
+    for (long i = 0; (i < run_count) && (jobs == 0); ++i) {
+        if ( !is_rand )
+            srand(42);
+        const CompiledGrid &cgrid = cgrids[i % cgrids.size()];
+        auto start = std::chrono::steady_clock::now();
+        unsigned long long allocs_before = alloc_count, bytes_before = alloc_bytes;
+        if ( best_ms > 0 ) {
+            std::vector< BestCrossPoint > curve;
+            bool is_optimal = gen_ctx.generateBest(cgrid, best_ms, ids_out, &curve);
+            std::printf("Curve of #%-2li (time, score, nodes):\n", i+1);
+            for (auto &p: curve)
+                std::printf("  %10.3f ms %10lld %12llu\n", p.time_us / 1000.0, p.score,
+                    static_cast<unsigned long long>(p.nodes));
+            if ( is_optimal && !ids_out.empty() )
+                std::printf("  the last fill is optimal\n");
+        } else if ( engine == SolverEngine::Backtracking ) {
+            gen_ctrl.reset();
+            gen_ctx.generate(cgrid, ids_out, &gen_ctrl);
+            gen_nodes += gen_ctrl.nodes;
+            if ( !checkpoint_path.empty() ) {
+                if ( gen_ctrl.cancel ) {
+                    std::printf("Search of #%-2li is interrupted after %llu nodes, it is saved to %s.\n",
+                        i+1, static_cast<unsigned long long>(gen_ctrl.nodes), checkpoint_path.c_str());
+                    return 1;
+                }
+                // Finished search has nothing to resume
+                std::remove(checkpoint_path.c_str());
+            }
+        } else {
+            generateCrossIds(cgrid, dict.words, engine, ids_out);
+        }
+        unsigned long long allocs = alloc_count - allocs_before, bytes = alloc_bytes - bytes_before;
+        gen_allocs += allocs;
+        gen_bytes  += bytes;
+        if ( ids_out.size() == 0 )
+            std::printf("Error in creating #%-2li!\n",i+1);
+        else
+            fill_scores.push_back(getCrossScore(dict.words, ids_out));
+        durs.at(i) = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        if ( is_verbose )
+            std::printf("Time to generate  #%-2li is %lld ms, %llu allocations of %llu bytes\n",
+                i+1, durs.at(i), allocs, bytes);
+        if ( (regen_count > 0) && !ids_out.empty() ) {
+            std::vector< size_t > unlock;
+            for (long k = 0; k < regen_count; ++k)
+                unlock.push_back(rand() % cgrid.winfos.size());
+            std::vector< WordUniq > regen_out;
+            start = std::chrono::steady_clock::now();
+            regenerateCrossIds(cgrid, dict.words, ids_out, unlock, regen_out);
+            regen_durs.push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count());
+            if ( regen_out.empty() )
+                std::printf("Error in regenerating #%-2li!\n", i+1);
+            else
+                ids_out.swap(regen_out);
+            if ( is_verbose )
+                std::printf("Time to regenerate #%-2li is %lld us\n", i+1, regen_durs.back());
+        }
+        if ( !is_export || ids_out.empty() )
+            continue;
+        crosses.push_back(FilledCrossword());
+        FilledCrossword &cross = crosses.back();
+        cross.grid  = cgrid.grid;
+        cross.words = cgrid.winfos;
+        gen_ctx.getWords(ids_out, cross.ans);
+        TraceScope trace("chooseClues");
+        for (auto id: ids_out)
+            cross.ques.push_back(getRandClue(dict.clues, id));
+    }
+    long long tm_total = std::accumulate(durs.begin(),durs.end(), 0LL);
+    long long tm_mean  = (tm_total + run_count/2) / run_count;
+    std::printf("Total time = %lld ms.\nMean time  = %lld ms.\n", tm_total, tm_mean);
+    // Allocations of workers aren't counted
+    if ( jobs == 0 )
+        std::printf("Mean allocations = %llu (%llu bytes).\n", (gen_allocs + run_count/2) / run_count,
+            (gen_bytes + run_count/2) / run_count);
+    if ( gen_nodes > 0 )
+        std::printf("Mean nodes = %llu.\n", (gen_nodes + run_count/2) / run_count);
+    if ( !fill_scores.empty() ) {
+        long long score_total = std::accumulate(fill_scores.begin(), fill_scores.end(), 0LL);
+        std::printf("Mean score = %lld.\n",
+            (score_total + fill_scores.size()/2) / static_cast<long long>(fill_scores.size()));
+    }
+    if ( !regen_durs.empty() ) {
+        long long regen_total = std::accumulate(regen_durs.begin(), regen_durs.end(), 0LL);
+        std::printf("Mean regeneration time = %lld us.\n",
+            (regen_total + regen_durs.size()/2) / static_cast<long long>(regen_durs.size()));
+    }
+    if ( !out_path.empty() ) {
+        auto start = std::chrono::steady_clock::now();
+        if ( !exportToFile(crosses, out_path, out_format, ExportTitles(), image_opts) ) {
+            std::fprintf(stderr, "Cannot export to %s\n", out_path.c_str());
+            return -1;
+        }
+        std::printf("Export time = %lld ms.\n", static_cast<long long>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count()));
+    }
+    if ( !images_prefix.empty() ) {
+        // Text and JSON have no images, so they mean default PNG
+        ExportFormat format = out_format == ExportFormat::Svg ? ExportFormat::Svg : ExportFormat::Png;
+        auto start = std::chrono::steady_clock::now();
+        if ( !exportImages(crosses, images_prefix, format, image_opts, static_cast<size_t>(jobs)) ) {
+            std::fprintf(stderr, "Cannot export images to %s*\n", images_prefix.c_str());
+            return -1;
+        }
+        std::printf("Images time = %lld ms for %zu images.\n", static_cast<long long>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count()), crosses.size());
+    }
+    if ( !trace_path.empty() && !writeTrace(trace_path) ) {
+        std::fprintf(stderr, "Cannot write trace to %s\n", trace_path.c_str());
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,155 @@
+#include "crossanalyze.hpp"
+
+#include <cmath>
+#include <map>
+
+#include "crosstrace.hpp"
+
+// Number of words with every letter at every position, by length
+typedef std::vector< std::vector< std::vector<uint32_t> > > LetterCounts;
+
+template <class TChar>
+static void countLetters(const WordsStorageT<TChar> &words, const std::vector<size_t> &slots_by_len,
+    LetterCounts &counts_out){
+    counts_out.assign(slots_by_len.size(), std::vector< std::vector<uint32_t> >());
+    for (size_t len = 1; len < slots_by_len.size(); ++len) {
+        if ( (slots_by_len[len] == 0) || (len >= words.size()) )
+            continue;
+        auto &counts = counts_out[len];
+        counts.resize(len);
+        for (auto &w: words[len])
+            for (size_t i = 0; i < len; ++i) {
+                if ( counts[i].size() <= w[i] )
+                    counts[i].resize(w[i] + 1, 0);
+                ++counts[i][w[i]];
+            }
+    }
+}
+
+// Lengths without words have no counts
+static uint32_t getCount(const LetterCounts &counts, size_t len, size_t pos, size_t ch){
+    if ( counts[len].empty() )
+        return 0;
+    const std::vector<uint32_t> &c = counts[len][pos];
+    return ch < c.size() ? c[ch] : 0;
+}
+
+// Word is kept if every its crossed letter can be at crossing position of
+// other slot too. Slots with the same lengths of crossing slots at the same
+// positions have equal domains, they are counted once
+template <class TChar>
+static void countDomains(const CompiledGrid &cgrid, const WordsStorageT<TChar> &words,
+    const LetterCounts &counts, std::vector<size_t> &domains_out){
+    const std::vector<WordInfo> &winfos = cgrid.winfos;
+    domains_out.assign(winfos.size(), 0);
+    std::map< std::vector<uint32_t>, size_t > known;
+    std::vector< uint32_t > key;
+    for (size_t s = 0; s < winfos.size(); ++s) {
+        size_t len = winfos[s].len;
+        if ( len >= words.size() )
+            continue;
+        key.clear();
+        for (size_t i = 0; i < len; ++i) {
+            const SlotPos &cross = cgrid.crossOf(s, i);
+            bool crossed = cross.slot != CompiledGrid::NO_SLOT;
+            key.push_back(crossed ? static_cast<uint32_t>(winfos[cross.slot].len) : 0);
+            key.push_back(crossed ? cross.pos : 0);
+        }
+        auto it = known.find(key);
+        if ( it != known.end() ) {
+            domains_out[s] = it->second;
+            continue;
+        }
+        for (auto &w: words[len]) {
+            bool fits = true;
+            for (size_t i = 0; (i < len) && fits; ++i) {
+                const SlotPos &cross = cgrid.crossOf(s, i);
+                if ( cross.slot != CompiledGrid::NO_SLOT )
+                    fits = getCount(counts, winfos[cross.slot].len, cross.pos, w[i]) > 0;
+            }
+            if ( fits )
+                ++domains_out[s];
+        }
+        known[key] = domains_out[s];
+    }
+}
+
+template <class TChar>
+static void analyzeGridT(const CompiledGrid &cgrid, const WordsStorageT<TChar> &words,
+    GridAnalysis &a){
+    const std::vector<WordInfo> &winfos = cgrid.winfos;
+    for (auto &wi: winfos) {
+        if ( a.slots_by_len.size() <= wi.len )
+            a.slots_by_len.resize(wi.len + 1, 0);
+        ++a.slots_by_len[wi.len];
+        a.slot_letters += wi.len;
+    }
+    a.words_by_len.assign(a.slots_by_len.size(), 0);
+    for (size_t len = 0; (len < a.words_by_len.size()) && (len < words.size()); ++len)
+        a.words_by_len[len] = words[len].size();
+    for (size_t s = 0; s < winfos.size(); ++s)
+        for (size_t i = 0; i < winfos[s].len; ++i)
+            if ( cgrid.crossOf(s, i).slot != CompiledGrid::NO_SLOT )
+                ++a.crossings;
+    // Every crossing is seen from both slots
+    a.crossings /= 2;
+    a.crossing_density = a.slot_letters == 0 ? 0 : 2.0 * a.crossings / a.slot_letters;
+
+    LetterCounts counts;
+    countLetters(words, a.slots_by_len, counts);
+    countDomains(cgrid, words, counts, a.domains);
+
+    // Words are used once, so slots of one length need so many distinct words
+    bool hopeless = false;
+    for (size_t len = 0; len < a.slots_by_len.size(); ++len)
+        hopeless = hopeless || (a.slots_by_len[len] > a.words_by_len[len]);
+    for (auto d: a.domains)
+        hopeless = hopeless || (d == 0);
+    if ( hopeless ) {
+        a.difficulty = GridDifficulty::Hopeless;
+        return;
+    }
+
+    double log_match = 0;
+    for (size_t s = 0; s < winfos.size(); ++s) {
+        size_t len = winfos[s].len;
+        a.log_space += std::log10(static_cast<double>(words[len].size()));
+        for (size_t i = 0; i < len; ++i) {
+            const SlotPos &cross = cgrid.crossOf(s, i);
+            if ( (cross.slot == CompiledGrid::NO_SLOT) || (cross.slot < s) )
+                continue;
+            // Probability that random words of both slots have equal letters here
+            size_t cross_len = winfos[cross.slot].len;
+            const std::vector<uint32_t> &c = counts[len][i];
+            double match = 0;
+            for (size_t ch = 0; ch < c.size(); ++ch)
+                match += static_cast<double>(c[ch]) * getCount(counts, cross_len, cross.pos, ch);
+            match /= static_cast<double>(words[len].size()) * words[cross_len].size();
+            log_match += std::log10(match);
+        }
+    }
+    a.log_fills       = a.log_space + log_match;
+    a.constrainedness = a.log_space > 0 ? -log_match / a.log_space : 0;
+    bool hard = (a.log_fills < HARD_LOG_FILLS) || (a.constrainedness > HARD_CONSTRAINEDNESS);
+    a.difficulty      = hard ? GridDifficulty::Hard : GridDifficulty::Easy;
+}
+
+void analyzeGrid(const CompiledGrid &cgrid, const AllWordsType &words, GridAnalysis &analysis_out){
+    TraceScope trace("analyzeGrid");
+    analysis_out = GridAnalysis();
+    if ( words.wide )
+        analyzeGridT(cgrid, words.wide_words, analysis_out);
+    else
+        analyzeGridT(cgrid, words.narrow_words, analysis_out);
+}
+
+const char* getDifficultyName(GridDifficulty difficulty){
+    switch ( difficulty ) {
+        case GridDifficulty::Easy:
+            return "easy";
+        case GridDifficulty::Hard:
+            return "hard";
+        default:
+            return "hopeless";
+    }
+}
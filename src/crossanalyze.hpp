@@ -0,0 +1,51 @@
+#ifndef CROSSANALYZE_HPP
+#define CROSSANALYZE_HPP
+
+#include <vector>
+
+#include "crossbasetypes.hpp"
+#include "crossgrid.hpp"
+
+// Compatibility of grid with dictionary and rough difficulty of search. It
+// takes milliseconds, so it can be done before every generation to choose
+// solver or to reject grid
+
+enum class GridDifficulty {
+    Easy,    // many fills are expected, backtracking finds one fast
+    Hard,    // few fills are expected, search can take long or find nothing
+    Hopeless // some slot has no candidates or there are too few words of its length
+};
+
+struct GridAnalysis {
+    std::vector< size_t > slots_by_len;    // number of slots of every length
+    std::vector< size_t > words_by_len;    // number of words of every length
+    size_t                slot_letters;    // letters of all slots
+    size_t                crossings;       // cells shared by two slots
+    double                crossing_density; // share of letters of slots which are crossed
+    std::vector< size_t > domains;         // candidates of every slot after one consistency pass
+    // Random words of their lengths are put to slots. Space is log10 of number
+    // of such fills and log_fills is log10 of expected number of fills with
+    // equal letters in every crossing, letters of crossing are taken by
+    // frequencies at their positions
+    double                log_space;
+    double                log_fills;
+    // Share of space cut by crossings: 1 - log_fills / log_space. Search is
+    // the hardest near 1
+    double                constrainedness;
+    GridDifficulty        difficulty;
+
+    GridAnalysis(): slot_letters(0), crossings(0), crossing_density(0), log_space(0),
+        log_fills(0), constrainedness(0), difficulty(GridDifficulty::Easy) {}
+};
+
+// Grid is Hard if less than 10^HARD_LOG_FILLS fills are expected or its
+// constrainedness is above HARD_CONSTRAINEDNESS. Letters of real words aren't
+// independent, so dense grids are harder than expected number of fills says
+const double HARD_LOG_FILLS       = 3;
+const double HARD_CONSTRAINEDNESS = 0.75;
+
+void analyzeGrid(const CompiledGrid &cgrid, const AllWordsType &words, GridAnalysis &analysis_out);
+
+const char* getDifficultyName(GridDifficulty difficulty);
+
+#endif // CROSSANALYZE_HPP
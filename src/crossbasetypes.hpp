@@ -4,22 +4,204 @@
 #include <set>
 #include <vector>
 #include <cstdint>
-#include <map>
+#include <memory>
+#include <string>
 
-// TODO: Improve worling with multiple definition of words. Move working with it
-// to crossgen.cpp from fmain.cpp
-typedef std::multimap< wxString, wxString > DictType;
-typedef std::vector< std::vector< wxChar > > GridType;
+#include "crossdawg.hpp"
+#include "crossutils.hpp"
 
-typedef uint8_t TransedChar;
-typedef std::vector< TransedChar > TransedWord;
+struct DictEntry {
+    StrRef word;
+    StrRef clue;
+};
+
+// Dictionary as it is in file, lines in order of file. All text is in one
+// arena, equal words and clues are stored once. Is used only while loading,
+// clues of prepared dictionary are in ClueIndex
+struct DictType {
+    std::shared_ptr< StringArena > text;
+    std::vector< DictEntry >       entries;
+
+    DictType(): text(std::make_shared<StringArena>()) {}
+
+    // Arena can be shared with ClueIndex, so new one is created
+    void clear() {
+        text = std::make_shared<StringArena>();
+        entries.clear();
+    }
+
+    bool empty() const {
+        return entries.empty();
+    }
+
+    size_t size() const {
+        return entries.size();
+    }
+};
+typedef std::vector< std::vector< char32_t > > GridType;
+
+// Letter of 8-bit alphabet, up to 254 letters (two codes are for cells)
+typedef uint8_t  TransedChar;
+// Letter of 16-bit alphabet for big (merged or CJK-style) dictionaries
+typedef uint16_t WideTransedChar;
+
+template <class TChar>
+using TransedWordT  = std::vector< TChar >;
+template <class TChar>
+using WorkGridT     = std::vector< std::vector< TChar > >;
+// Fisrt index is a word length. Buckets are shared by versions of dictionary
+// made by deltas, read-only access is like to std::vector
+template <class TChar>
+using WordsStorageT = std::vector< SharedVector< TransedWordT< TChar > > >;
+// Optional automatons of length buckets, first index is a word length
+template <class TChar>
+using WordsDawgsT   = std::vector< WordsDawg< TChar > >;
+
+typedef TransedWordT< TransedChar > TransedWord;
+typedef WorkGridT< TransedChar >    WorkGridType;
+
+// Codes of letters. Code of letter is found by two-level table: high bits of
+// letter give page of 256 codes, pages without letters share empty page 0.
+// Letter of code is found by array, codes are given one by one
+class CharsTransType {
+public:
+    static const uint32_t NO_CODE   = 0xFFFFFFFF;
+    static const size_t   PAGE_BITS = 8;
+    static const size_t   PAGE_SIZE = 1 << PAGE_BITS;
+
+protected:
+    std::vector< uint16_t > _pages;   // page of every PAGE_SIZE letters
+    std::vector< uint32_t > _codes;   // codes of all pages, NO_CODE if there is no letter
+    std::vector< char32_t > _letters; // letter by code
+
+public:
+    CharsTransType(): _codes(PAGE_SIZE, NO_CODE) {}
+
+    void clear() {
+        _pages.clear();
+        _codes.assign(PAGE_SIZE, NO_CODE);
+        _letters.clear();
+    }
+
+    bool empty() const {
+        return _letters.empty();
+    }
+
+    // Number of letters, it is the next free code too
+    size_t size() const {
+        return _letters.size();
+    }
+
+    // NO_CODE if there is no such letter
+    uint32_t code(char32_t ch) const {
+        const size_t page = ch >> PAGE_BITS;
+        if ( page >= _pages.size() )
+            return NO_CODE;
+        return _codes[(static_cast<size_t>(_pages[page]) << PAGE_BITS) | (ch & (PAGE_SIZE - 1))];
+    }
+
+    bool contains(char32_t ch) const {
+        return code(ch) != NO_CODE;
+    }
 
-typedef std::vector< std::vector< TransedChar > > WorkGridType;
-typedef std::map< wxChar, TransedChar > CharsTransType;
-typedef std::map< TransedChar, wxChar > BackedCharsTransType;
-// Fisrt index is a word length
-typedef std::vector< std::vector< TransedWord > > AllWordsType; 
-typedef std::set< uint32_t > UsedWords;
+    // Code must be valid
+    char32_t letter(size_t code) const {
+        return _letters[code];
+    }
+
+    const std::vector< char32_t >& letters() const {
+        return _letters;
+    }
+
+    // Gives the next code to new letter and returns it, code of known letter
+    // is returned as it is
+    uint32_t add(char32_t ch) {
+        uint32_t res = code(ch);
+        if ( res != NO_CODE )
+            return res;
+        const size_t page = ch >> PAGE_BITS;
+        if ( page >= _pages.size() )
+            _pages.resize(page + 1, 0);
+        if ( _pages[page] == 0 ) {
+            _pages[page] = static_cast<uint16_t>(_codes.size() >> PAGE_BITS);
+            _codes.resize(_codes.size() + PAGE_SIZE, NO_CODE);
+        }
+        res = static_cast<uint32_t>(_letters.size());
+        _codes[(static_cast<size_t>(_pages[page]) << PAGE_BITS) | (ch & (PAGE_SIZE - 1))] = res;
+        _letters.push_back(ch);
+        return res;
+    }
+};
+
+// Index of word in its length bucket
+typedef uint32_t WordIndex;
+// Word length in high 32 bits and WordIndex in low 32 bits
+typedef uint64_t WordUniq;
+typedef std::set< WordUniq > UsedWords;
+
+// Width of alphabet is chosen by generateAllWords from dictionary:
+// only one of storages is filled. Automatons are built by buildWordsDawgs,
+// if they exist solver uses them to find words matching letters of slot
+struct AllWordsType {
+    bool                             wide;
+    WordsStorageT< TransedChar >     narrow_words;
+    WordsStorageT< WideTransedChar > wide_words;
+    std::vector< SharedVector<int> > scores; // the same layout as words, bigger is better
+    WordsDawgsT< TransedChar >       narrow_dawgs;
+    WordsDawgsT< WideTransedChar >   wide_dawgs;
+
+    AllWordsType(): wide(false) {}
+
+    void clear() {
+        wide = false;
+        narrow_words.clear();
+        wide_words.clear();
+        scores.clear();
+        narrow_dawgs.clear();
+        wide_dawgs.clear();
+    }
+
+    bool hasDawgs() const {
+        return !narrow_dawgs.empty() || !wide_dawgs.empty();
+    }
+
+    bool empty() const {
+        return narrow_words.empty() && wide_words.empty();
+    }
+
+    // Number of length buckets
+    size_t size() const {
+        return wide ? wide_words.size() : narrow_words.size();
+    }
+
+    size_t count(size_t len) const {
+        if ( len >= size() )
+            return 0;
+        return wide ? wide_words[len].size() : narrow_words[len].size();
+    }
+};
+
+// Clues of one word with length len are ClueIndex::clues[len][first, last)
+struct ClueRange {
+    uint32_t first;
+    uint32_t last;
+};
+
+// Clues of words from AllWordsType. ranges has the same layout as storage of
+// words: ranges[len][ind] belongs to word with length len and WordIndex ind.
+// Clues are by lengths too, so delta changes only clues of its lengths.
+// Text of clues is in arena of dictionary, it is shared, not copied
+struct ClueIndex {
+    std::shared_ptr< const StringArena >     text;
+    std::vector< SharedVector< StrRef > >    clues;
+    std::vector< SharedVector< ClueRange > > ranges;
+
+    void clear() {
+        text.reset();
+        clues.clear();
+        ranges.clear();
+    }
+};
 
 struct WordInfo {
     size_t x;
@@ -33,8 +215,8 @@ struct WordInfo {
 struct FilledCrossword {
     GridType grid;
     std::vector< WordInfo > words;
-    std::vector< wxString > ques;
-    std::vector< wxString > ans;
+    std::vector< std::u32string > ques;
+    std::vector< std::u32string > ans;
 };
 
 #endif // CROSSBASETYPES_HPP
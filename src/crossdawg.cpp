@@ -0,0 +1,182 @@
+#include "crossdawg.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <utility>
+
+#include "crossgen.hpp"
+
+template <class TChar>
+void WordsDawg<TChar>::build(const std::vector< std::vector<TChar> > &words){
+    clear();
+    if ( words.empty() || words.at(0).empty() )
+        return;
+    _len = words.at(0).size();
+
+    // Words in lexicographical order, rank of word is its index here
+    std::vector< uint32_t > order(words.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&words](uint32_t a, uint32_t b){
+        return words[a] < words[b];
+    });
+    order.erase(std::unique(order.begin(), order.end(), [&words](uint32_t a, uint32_t b){
+        return words[a] == words[b];
+    }), order.end());
+
+    // Incremental building from sorted words (Daciuk et al.): nodes of
+    // previous word below common prefix with current one won't get new
+    // edges, so they are replaced by equal registered nodes
+    typedef std::vector< std::pair<TChar, uint32_t> > Edges;
+    std::vector< Edges >        nodes(1);
+    std::map< Edges, uint32_t > registry;
+    std::vector< uint32_t >     path(_len + 1, 0);
+    auto minimize = [&](size_t down_to) {
+        for (size_t d = _len; d > down_to; --d) {
+            auto it = registry.find(nodes[path[d]]);
+            if ( it != registry.end() )
+                nodes[path[d - 1]].back().second = it->second;
+            else
+                registry.insert(std::make_pair(nodes[path[d]], path[d]));
+        }
+    };
+    for (size_t k = 0; k < order.size(); ++k) {
+        const std::vector<TChar> &word = words[order[k]];
+        size_t prefix = 0;
+        if ( k > 0 ) {
+            const std::vector<TChar> &prev = words[order[k - 1]];
+            while ( (prefix < _len) && (prev[prefix] == word[prefix]) )
+                ++prefix;
+            minimize(prefix);
+        }
+        for (size_t d = prefix; d < _len; ++d) {
+            uint32_t id = static_cast<uint32_t>(nodes.size());
+            nodes.push_back(Edges());
+            nodes[path[d]].push_back(std::make_pair(word[d], id));
+            path[d + 1] = id;
+        }
+    }
+    minimize(0);
+    registry.clear();
+
+    // All words have the same length, so every node has one depth and
+    // breadth-first order is topological one
+    const uint32_t NO_ID = std::numeric_limits<uint32_t>::max();
+    std::vector< uint32_t > new_ids(nodes.size(), NO_ID);
+    std::vector< uint32_t > bfs(1, 0);
+    new_ids[0] = 0;
+    for (size_t i = 0; i < bfs.size(); ++i)
+        for (auto &e: nodes[bfs[i]])
+            if ( new_ids[e.second] == NO_ID ) {
+                new_ids[e.second] = static_cast<uint32_t>(bfs.size());
+                bfs.push_back(e.second);
+            }
+
+    std::vector< uint32_t > edges_first, targets, edge_ranks, counts;
+    std::vector< TChar >    labels;
+    edges_first.reserve(bfs.size() + 1);
+    for (auto old_id: bfs) {
+        edges_first.push_back(static_cast<uint32_t>(labels.size()));
+        for (auto &e: nodes[old_id]) {
+            labels.push_back(e.first);
+            targets.push_back(new_ids[e.second]);
+        }
+    }
+    edges_first.push_back(static_cast<uint32_t>(labels.size()));
+
+    counts.assign(bfs.size(), 0);
+    edge_ranks.resize(targets.size());
+    for (size_t i = bfs.size(); i-- > 0; ) {
+        if ( edges_first[i] == edges_first[i + 1] ) {
+            counts[i] = 1;
+            continue;
+        }
+        for (uint32_t e = edges_first[i]; e < edges_first[i + 1]; ++e) {
+            edge_ranks[e] = counts[i];
+            counts[i]    += counts[targets[e]];
+        }
+    }
+    _edgesFirst = SharedVector< uint32_t >(std::move(edges_first));
+    _labels     = SharedVector< TChar >(std::move(labels));
+    _targets    = SharedVector< uint32_t >(std::move(targets));
+    _edgeRanks  = SharedVector< uint32_t >(std::move(edge_ranks));
+    _counts     = SharedVector< uint32_t >(std::move(counts));
+    _lexToIndex = SharedVector< uint32_t >(std::move(order));
+}
+
+template <class TChar>
+void WordsDawg<TChar>::clear(){
+    *this = WordsDawg();
+}
+
+template <class TChar>
+size_t WordsDawg<TChar>::memoryUsage() const{
+    return (_edgesFirst.size() + _targets.size() + _edgeRanks.size() + _counts.size() +
+        _lexToIndex.size()) * sizeof(uint32_t) + _labels.size() * sizeof(TChar);
+}
+
+template <class TChar>
+void WordsDawg<TChar>::matchNode(const std::vector<TChar> &pattern, size_t free_from,
+        uint32_t node, size_t depth, uint32_t rank, std::vector<uint32_t> &inds_out) const{
+    if ( depth >= free_from ) {
+        // Rest of pattern is free, so all words below node are matched
+        inds_out.insert(inds_out.end(), _lexToIndex.begin() + rank,
+            _lexToIndex.begin() + rank + _counts[node]);
+        return;
+    }
+    auto first = _labels.begin() + _edgesFirst[node];
+    auto last  = _labels.begin() + _edgesFirst[node + 1];
+    if ( pattern[depth] != TRANS_CLEAR ) {
+        auto it = std::lower_bound(first, last, pattern[depth]);
+        if ( (it == last) || (*it != pattern[depth]) )
+            return;
+        size_t e = it - _labels.begin();
+        matchNode(pattern, free_from, _targets[e], depth + 1, rank + _edgeRanks[e], inds_out);
+        return;
+    }
+    for (uint32_t e = _edgesFirst[node]; e < _edgesFirst[node + 1]; ++e)
+        matchNode(pattern, free_from, _targets[e], depth + 1, rank + _edgeRanks[e], inds_out);
+}
+
+template <class TChar>
+void WordsDawg<TChar>::match(const std::vector<TChar> &pattern, std::vector<uint32_t> &inds_out) const{
+    if ( empty() || (pattern.size() != _len) )
+        return;
+    size_t free_from = _len;
+    while ( (free_from > 0) && (pattern[free_from - 1] == TRANS_CLEAR) )
+        --free_from;
+    matchNode(pattern, free_from, 0, 0, 0, inds_out);
+}
+
+template <class TChar>
+size_t WordsDawg<TChar>::countNode(const std::vector<TChar> &pattern, size_t free_from,
+        uint32_t node, size_t depth, size_t limit) const{
+    if ( depth >= free_from )
+        return _counts[node];
+    if ( pattern[depth] != TRANS_CLEAR ) {
+        auto first = _labels.begin() + _edgesFirst[node];
+        auto last  = _labels.begin() + _edgesFirst[node + 1];
+        auto it    = std::lower_bound(first, last, pattern[depth]);
+        if ( (it == last) || (*it != pattern[depth]) )
+            return 0;
+        return countNode(pattern, free_from, _targets[it - _labels.begin()], depth + 1, limit);
+    }
+    size_t res = 0;
+    for (uint32_t e = _edgesFirst[node]; (e < _edgesFirst[node + 1]) && (res < limit); ++e)
+        res += countNode(pattern, free_from, _targets[e], depth + 1, limit - res);
+    return res;
+}
+
+template <class TChar>
+size_t WordsDawg<TChar>::count(const std::vector<TChar> &pattern, size_t limit) const{
+    if ( empty() || (pattern.size() != _len) || (limit == 0) )
+        return 0;
+    size_t free_from = _len;
+    while ( (free_from > 0) && (pattern[free_from - 1] == TRANS_CLEAR) )
+        --free_from;
+    return std::min(countNode(pattern, free_from, 0, 0, limit), limit);
+}
+
+template class WordsDawg<TransedChar>;
+template class WordsDawg<WideTransedChar>;
@@ -0,0 +1,58 @@
+#ifndef CROSSDAWG_HPP
+#define CROSSDAWG_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "crossutils.hpp"
+
+// Minimized acyclic automaton (DAWG) of one length bucket of words. Every
+// node knows number of words below it, so path to word gives its rank in
+// lexicographical order, and _lexToIndex gives index of word in bucket.
+// It is index over the bucket, not compressed form of it: words are still
+// read from flat storage, and automaton adds its nodes and edges and 4 bytes
+// of _lexToIndex for every word to memory of dictionary.
+// Letter TRANS_CLEAR (0) in pattern matches any letter. Copies share arrays,
+// so versions of dictionary don't copy automatons of unchanged buckets
+template <class TChar>
+class WordsDawg {
+protected:
+    size_t                   _len;        // length of every word
+    SharedVector< uint32_t > _edgesFirst; // edges of node i are [_edgesFirst[i], _edgesFirst[i+1])
+    SharedVector< TChar >    _labels;     // sorted inside every node
+    SharedVector< uint32_t > _targets;
+    SharedVector< uint32_t > _edgeRanks;  // number of words below previous edges of node
+    SharedVector< uint32_t > _counts;     // number of words below node
+    SharedVector< uint32_t > _lexToIndex;
+
+    // Pattern has only free letters starting from free_from
+    void matchNode(const std::vector<TChar> &pattern, size_t free_from, uint32_t node,
+        size_t depth, uint32_t rank, std::vector<uint32_t> &inds_out) const;
+    size_t countNode(const std::vector<TChar> &pattern, size_t free_from, uint32_t node,
+        size_t depth, size_t limit) const;
+
+public:
+    WordsDawg(): _len(0) {}
+
+    // All words of bucket must have the same length, index of word in bucket
+    // is its index in words
+    void build(const std::vector< std::vector<TChar> > &words);
+    void clear();
+
+    bool empty() const {
+        return _lexToIndex.empty();
+    }
+    size_t nodesCount() const {
+        return _counts.size();
+    }
+    // Memory of automaton in bytes, without fixed size of object
+    size_t memoryUsage() const;
+
+    // Appends indexes (not sorted) of words matching pattern to inds_out
+    void match(const std::vector<TChar> &pattern, std::vector<uint32_t> &inds_out) const;
+    // Number of words matching pattern, counting stops at limit
+    size_t count(const std::vector<TChar> &pattern, size_t limit) const;
+};
+
+#endif // CROSSDAWG_HPP
@@ -1,5 +1,29 @@
 #include "crossexport.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+#include "crosstrace.hpp"
+
+static const std::u32string LINE_END = U"\n";
+
+bool parseExportFormat(const std::string &name, ExportFormat &format_out){
+    if ( name == "text" )
+        format_out = ExportFormat::Text;
+    else if ( name == "json" )
+        format_out = ExportFormat::Json;
+    else if ( name == "svg" )
+        format_out = ExportFormat::Svg;
+    else if ( name == "png" )
+        format_out = ExportFormat::Png;
+    else
+        return false;
+    return true;
+}
+
 void fillCross(FilledCrossword &cross){
     for ( size_t i = 0; i < cross.words.size(); ++i ) {
         if ( cross.words.at(i).direct == true ) {
@@ -13,66 +37,370 @@ void fillCross(FilledCrossword &cross){
     }
 }
 
-wxString getGridString(const FilledCrossword &cross, wxChar space = wxT('-')){
-    const wxString LINE_END = wxTextFile::GetEOL();
-    
-    wxString t_string;
-    
-    FilledCrossword t_cross(cross);
-    if ( !t_cross.ans.empty() ) {
-        fillCross(t_cross);
+void fillCells(const FilledCrossword &cross, std::vector<char32_t> &cells_out){
+    const size_t w = cross.grid.size();
+    const size_t h = w > 0 ? cross.grid[0].size() : 0;
+    cells_out.resize(w * h);
+    for (size_t x = 0; x < w; ++x)
+        for (size_t y = 0; y < h; ++y)
+            cells_out[y * w + x] = cross.grid[x][y];
+    if ( cross.ans.size() != cross.words.size() )
+        return;
+    for (size_t i = 0; i < cross.words.size(); ++i) {
+        const WordInfo       &wi  = cross.words[i];
+        const std::u32string &ans = cross.ans[i];
+        const size_t          len = std::min(wi.len, ans.size());
+        if ( wi.direct ) {
+            for (size_t j = 0; j < len; ++j)
+                cells_out[wi.y * w + wi.x + j] = ans[j];
+        } else {
+            for (size_t j = 0; j < len; ++j)
+                cells_out[(wi.y + j) * w + wi.x] = ans[j];
+        }
     }
-    for (size_t i = 0; i < t_cross.grid.at(0).size(); ++i){
-        for (size_t j = 0; j < t_cross.grid.size(); ++j){
-            if ( t_cross.grid.at(j).at(i) == CELL_BORDER )
-                t_string += space;
-            else
-                t_string += t_cross.grid.at(j).at(i);
+}
+
+std::u32string getGridString(const FilledCrossword &cross, char32_t space){
+    std::vector<char32_t> cells;
+    fillCells(cross, cells);
+    const size_t w = cross.grid.size();
+    const size_t h = w > 0 ? cross.grid[0].size() : 0;
+
+    std::u32string t_string;
+    t_string.reserve((w + LINE_END.size()) * h);
+    for (size_t i = 0; i < h; ++i){
+        for (size_t j = 0; j < w; ++j){
+            char32_t ch = cells[i * w + j];
+            t_string += ch == CELL_BORDER ? space : ch;
         }
         t_string += LINE_END;
     }
     return t_string;
 }
 
-wxString getQuesString(const FilledCrossword &cross){
-    const wxString LINE_END = wxTextFile::GetEOL();
-    
-    wxString t_string;
-    
+std::u32string getQuesString(const FilledCrossword &cross, const ExportTitles &titles){
+    std::u32string t_string;
+
     if ( !cross.ques.empty() ) { // == print questions
-        t_string += _("Vertical words:") + LINE_END;
-            
+        t_string += titles.vert + LINE_END;
+
         for (size_t i = 0; i < cross.words.size(); ++i){
             if (cross.words.at(i).direct == false)
-                t_string += wxString::Format(wxT("%d. "), cross.words.at(i).ind) 
+                t_string += toU32(cross.words.at(i).ind) + U". "
                   + cross.ques.at(i) + LINE_END;
         }
-        
-        t_string += _("Horisontal words:") + LINE_END;
-        
+
+        t_string += titles.hor + LINE_END;
+
         for (size_t i = 0; i < cross.words.size(); ++i){
             if (cross.words.at(i).direct == true)
-                t_string += wxString::Format(wxT("%d. "), cross.words.at(i).ind) 
+                t_string += toU32(cross.words.at(i).ind) + U". "
                   + cross.ques.at(i) + LINE_END;
         }
     }
     return t_string;
 }
 
-void exportToString(const FilledCrossword &cross, wxString &str_out, wxChar space = wxT('-')){
-    str_out += getGridString(cross, space) + getQuesString(cross);
+void exportToString(const FilledCrossword &cross, std::u32string &str_out,
+        char32_t space, const ExportTitles &titles){
+    TraceScope trace("exportToString");
+    str_out += getGridString(cross, space) + getQuesString(cross, titles);
+}
+
+void CrossWriter::put(char32_t ch){
+    putUtf8(_out, ch);
+}
+
+void CrossWriter::put(const std::u32string &s){
+    for (auto ch: s)
+        putUtf8(_out, ch);
+}
+
+void TextCrossWriter::putQues(const FilledCrossword &cross, bool direct,
+        const std::u32string &title){
+    put(title);
+    put(LINE_END);
+    for (size_t i = 0; i < cross.words.size(); ++i){
+        if ( cross.words[i].direct != direct )
+            continue;
+        _out << cross.words[i].ind << ". ";
+        put(cross.ques[i]);
+        put(LINE_END);
+    }
+}
+
+void TextCrossWriter::write(const FilledCrossword &cross){
+    if ( _count > 0 )
+        put(LINE_END);
+    fillCells(cross, _cells);
+    const size_t w = cross.grid.size();
+    const size_t h = w > 0 ? cross.grid[0].size() : 0;
+    for (size_t i = 0; i < h; ++i){
+        for (size_t j = 0; j < w; ++j){
+            char32_t ch = _cells[i * w + j];
+            put(ch == CELL_BORDER ? _space : ch);
+        }
+        put(LINE_END);
+    }
+    if ( !cross.ques.empty() ) {
+        putQues(cross, false, _titles.vert);
+        putQues(cross, true,  _titles.hor);
+    }
+    ++_count;
 }
 
-bool exportToFile(const FilledCrossword &cross, const wxString &path){
-    wxTextFile f(path);
-    if ( f.Exists() )
+void JsonCrossWriter::putJsonString(const std::u32string &s){
+    _out.put('"');
+    for (auto ch: s) {
+        switch ( ch ) {
+            case U'"':  put("\\\""); break;
+            case U'\\': put("\\\\"); break;
+            case U'\n': put("\\n");  break;
+            case U'\r': put("\\r");  break;
+            case U'\t': put("\\t");  break;
+            default:
+                if ( ch < 0x20 ) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned int>(ch));
+                    put(buf);
+                } else {
+                    put(ch);
+                }
+        }
+    }
+    _out.put('"');
+}
+
+void JsonCrossWriter::begin(){
+    put("[\n");
+}
+
+void JsonCrossWriter::write(const FilledCrossword &cross){
+    if ( _count > 0 )
+        put(",\n");
+    fillCells(cross, _cells);
+    const size_t w = cross.grid.size();
+    const size_t h = w > 0 ? cross.grid[0].size() : 0;
+    _out << "{\"width\": " << w << ", \"height\": " << h << ", \"grid\": [";
+    std::u32string row;
+    for (size_t i = 0; i < h; ++i) {
+        row.assign(_cells.begin() + i * w, _cells.begin() + (i + 1) * w);
+        if ( i > 0 )
+            put(", ");
+        putJsonString(row);
+    }
+    put("], \"words\": [");
+    for (size_t i = 0; i < cross.words.size(); ++i) {
+        const WordInfo &wi = cross.words[i];
+        if ( i > 0 )
+            put(", ");
+        _out << "{\"index\": " << wi.ind << ", \"x\": " << wi.x << ", \"y\": " << wi.y
+            << ", \"length\": " << wi.len << ", \"direction\": "
+            << (wi.direct ? "\"across\"" : "\"down\"");
+        if ( i < cross.ans.size() ) {
+            put(", \"answer\": ");
+            putJsonString(cross.ans[i]);
+        }
+        if ( i < cross.ques.size() ) {
+            put(", \"question\": ");
+            putJsonString(cross.ques[i]);
+        }
+        _out.put('}');
+    }
+    put("]}");
+    ++_count;
+}
+
+void JsonCrossWriter::end(){
+    put("\n]\n");
+    CrossWriter::end();
+}
+
+void SvgCrossWriter::putXmlText(char32_t ch){
+    switch ( ch ) {
+        case U'<': put("&lt;");  break;
+        case U'>': put("&gt;");  break;
+        case U'&': put("&amp;"); break;
+        default:   put(ch);
+    }
+}
+
+void SvgCrossWriter::begin(){
+    put("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    put("<svg xmlns=\"http://www.w3.org/2000/svg\"");
+    // Size is known only in end(), so place for it is reserved
+    _sizePos = _out.tellp();
+    if ( _sizePos != -1 )
+        put(" width=\"0000000000\" height=\"0000000000\"");
+    put(" font-family=\"sans-serif\">\n");
+}
+
+void SvgCrossWriter::write(const FilledCrossword &cross){
+    fillCells(cross, _cells);
+    const size_t w  = cross.grid.size();
+    const size_t h  = w > 0 ? cross.grid[0].size() : 0;
+    const int    sq = _cellSize;
+
+    if ( _count > 0 )
+        _height += GAP_CELLS * sq;
+    _out << "<g transform=\"translate(0," << _height << ")\">\n";
+    for (size_t y = 0; y < h; ++y)
+        for (size_t x = 0; x < w; ++x)
+            if ( cross.grid[x][y] != CELL_BORDER )
+                _out << "<rect x=\"" << x * sq << "\" y=\"" << y * sq << "\" width=\"" << sq
+                    << "\" height=\"" << sq << "\" fill=\"#d9e7c8\" stroke=\"#000\"/>\n";
+    for (auto &wi: cross.words)
+        _out << "<text x=\"" << wi.x * sq + 2 << "\" y=\"" << wi.y * sq + sq / 3
+            << "\" font-size=\"" << sq / 3 << "\">" << wi.ind << "</text>\n";
+    if ( _showAnswers && (cross.ans.size() == cross.words.size()) && !cross.ans.empty() ) {
+        for (size_t y = 0; y < h; ++y)
+            for (size_t x = 0; x < w; ++x) {
+                char32_t ch = _cells[y * w + x];
+                if ( (ch == CELL_BORDER) || (ch == CELL_CLEAR) )
+                    continue;
+                _out << "<text x=\"" << x * sq + sq / 2 << "\" y=\"" << y * sq + sq * 9 / 10
+                    << "\" font-size=\"" << sq * 6 / 10 << "\" text-anchor=\"middle\">";
+                putXmlText(ch);
+                put("</text>\n");
+            }
+    }
+    put("</g>\n");
+
+    _width   = std::max(_width, w * sq + 1);
+    _height += h * sq + 1;
+    ++_count;
+}
+
+void SvgCrossWriter::end(){
+    put("</svg>\n");
+    if ( _sizePos != -1 ) {
+        std::streamoff end_pos = _out.tellp();
+        char buf[48];
+        std::snprintf(buf, sizeof(buf), " width=\"%010lu\" height=\"%010lu\"",
+            static_cast<unsigned long>(_width), static_cast<unsigned long>(_height));
+        _out.seekp(_sizePos);
+        put(buf);
+        _out.seekp(end_pos);
+    }
+    CrossWriter::end();
+}
+
+const int PngCrossWriter::GAP_CELLS;
+
+void PngCrossWriter::write(const FilledCrossword &cross){
+    size_t w, h;
+    getCrossImageSize(cross, _opts, w, h);
+    _images.push_back(CrossImage());
+    _images.back().reset(w, h);
+    renderCross(cross, _opts, _images.back());
+    ++_count;
+}
+
+void PngCrossWriter::end(){
+    size_t width = 0, height = 0;
+    const size_t gap = GAP_CELLS * _opts.cell_size;
+    // Frames are 1 pixel wider than cells, gap hides it; only the last
+    // image keeps its extra row
+    for (auto &im: _images) {
+        width   = std::max(width, im.width);
+        height += im.height - 1 + gap;
+    }
+    if ( !_images.empty() )
+        height += 1 - gap;
+    CrossImage image;
+    image.reset(width, height);
+    size_t top = 0;
+    for (auto &im: _images) {
+        for (size_t y = 0; y < im.height; ++y)
+            std::copy_n(im.pixels.begin() + y * im.width, im.width,
+                image.pixels.begin() + (top + y) * width);
+        top += im.height - 1 + gap;
+    }
+    _images.clear();
+    writePng(image, _out);
+    CrossWriter::end();
+}
+
+std::unique_ptr<CrossWriter> makeCrossWriter(ExportFormat format, std::ostream &out,
+        const ExportTitles &titles, const ImageOptions &image_opts){
+    switch ( format ) {
+        case ExportFormat::Json:
+            return std::unique_ptr<CrossWriter>(new JsonCrossWriter(out));
+        case ExportFormat::Svg:
+            return std::unique_ptr<CrossWriter>(
+                new SvgCrossWriter(out, image_opts.cell_size, image_opts.show_answers));
+        case ExportFormat::Png:
+            return std::unique_ptr<CrossWriter>(new PngCrossWriter(out, image_opts));
+        default:
+            return std::unique_ptr<CrossWriter>(new TextCrossWriter(out, U'-', titles));
+    }
+}
+
+bool exportToFile(const FilledCrossword &cross, const std::string &path,
+        const ExportTitles &titles, ExportFormat format){
+    TraceScope trace("exportToFile");
+    if ( std::ifstream(path) )
         return false;
-    f.Create();
-    f.Open(path);
-    wxString cont;
-    exportToString(cross, cont);
-    f.AddLine(cont);
-    f.Write();
-    f.Close();
-    return true;
+    std::ofstream f(path, std::ios::binary);
+    if ( !f )
+        return false;
+    auto writer = makeCrossWriter(format, f, titles);
+    writer->begin();
+    writer->write(cross);
+    writer->end();
+    return static_cast<bool>(f);
+}
+
+bool exportToFile(const std::vector<FilledCrossword> &crosses, const std::string &path,
+        ExportFormat format, const ExportTitles &titles, const ImageOptions &image_opts){
+    TraceScope trace("exportToFile");
+    std::ofstream f(path, std::ios::binary);
+    if ( !f )
+        return false;
+    auto writer = makeCrossWriter(format, f, titles, image_opts);
+    writer->begin();
+    for (auto &cross: crosses)
+        writer->write(cross);
+    writer->end();
+    return static_cast<bool>(f);
+}
+
+bool exportImages(const std::vector<FilledCrossword> &crosses, const std::string &path_prefix,
+        ExportFormat format, const ImageOptions &opts, size_t threads){
+    TraceScope trace("exportImages");
+    if ( threads == 0 )
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, crosses.size());
+    const char *ext = format == ExportFormat::Svg ? ".svg" : ".png";
+    std::atomic< size_t > next(0);
+    std::atomic< bool >   ok(true);
+    // Crosswords are taken one by one, so big and small ones are shared evenly
+    auto work = [&]() {
+        setTraceThreadName("export");
+        CrossImage image;
+        for (size_t i = next++; i < crosses.size(); i = next++) {
+            TraceScope trace("renderImage");
+            std::ofstream f(path_prefix + std::to_string(i + 1) + ext, std::ios::binary);
+            if ( format == ExportFormat::Svg ) {
+                SvgCrossWriter writer(f, opts.cell_size, opts.show_answers);
+                writer.begin();
+                writer.write(crosses[i]);
+                writer.end();
+            } else {
+                size_t w, h;
+                getCrossImageSize(crosses[i], opts, w, h);
+                image.reset(w, h);
+                renderCross(crosses[i], opts, image);
+                writePng(image, f);
+            }
+            if ( !f )
+                ok = false;
+        }
+    };
+    std::vector< std::thread > pool;
+    for (size_t t = 0; t < threads; ++t)
+        pool.push_back(std::thread(work));
+    for (auto &th: pool)
+        th.join();
+    return ok;
 }
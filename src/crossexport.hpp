@@ -1,20 +1,158 @@
 #ifndef CROSSEXPORT_HPP
 #define CROSSEXPORT_HPP
 
-#include <wx/wx.h>
-#include <wx/textfile.h>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
 
 #include "crossgen.hpp"
 #include "crossbasetypes.hpp"
+#include "crossimage.hpp"
+
+// Headers of questions lists, GUI replaces them with translated ones
+struct ExportTitles {
+    std::u32string vert;
+    std::u32string hor;
+
+    ExportTitles(): vert(U"Vertical words:"), hor(U"Horisontal words:") {}
+};
+
+enum class ExportFormat {
+    Text,
+    Json,
+    Svg,
+    Png
+};
+
+// Accepts "text", "json", "svg" and "png"
+bool parseExportFormat(const std::string &name, ExportFormat &format_out);
 
 void fillCross(FilledCrossword &cross);
 
-wxString getGridString(const FilledCrossword &cross, wxChar space);
+// Cells of grid with answers in row-major order, reuses memory of cells_out
+void fillCells(const FilledCrossword &cross, std::vector<char32_t> &cells_out);
+
+std::u32string getGridString(const FilledCrossword &cross, char32_t space = U'-');
+
+std::u32string getQuesString(const FilledCrossword &cross,
+    const ExportTitles &titles = ExportTitles());
+
+void exportToString(const FilledCrossword &cross, std::u32string &str_out,
+    char32_t space = U'-', const ExportTitles &titles = ExportTitles());
+
+// Writes crosswords to stream in UTF-8 one after another without copying
+// them. Many crosswords are written to one stream as:
+//     begin(); write(a); write(b); ...; end();
+class CrossWriter {
+protected:
+    std::ostream          &_out;
+    size_t                 _count; // number of written crosswords
+    std::vector<char32_t>  _cells; // scratch buffer, reused between crosswords
+
+    void put(char32_t ch);
+    void put(const std::u32string &s);
+    void put(const char *s) {
+        _out << s;
+    }
+
+public:
+    explicit CrossWriter(std::ostream &out): _out(out), _count(0) {}
+    virtual ~CrossWriter() {}
+
+    virtual void begin() {}
+    virtual void write(const FilledCrossword &cross) = 0;
+    virtual void end() {
+        _out.flush();
+    }
+};
+
+// Same format as exportToString, crosswords are separated by empty line
+class TextCrossWriter: public CrossWriter {
+protected:
+    char32_t     _space;
+    ExportTitles _titles;
+
+    void putQues(const FilledCrossword &cross, bool direct, const std::u32string &title);
+
+public:
+    TextCrossWriter(std::ostream &out, char32_t space = U'-',
+        const ExportTitles &titles = ExportTitles()):
+            CrossWriter(out), _space(space), _titles(titles) {}
+
+    void write(const FilledCrossword &cross);
+};
+
+// Array of objects with width, height, rows of grid and list of words
+class JsonCrossWriter: public CrossWriter {
+protected:
+    void putJsonString(const std::u32string &s);
+
+public:
+    explicit JsonCrossWriter(std::ostream &out): CrossWriter(out) {}
+
+    void begin();
+    void write(const FilledCrossword &cross);
+    void end();
+};
+
+// One SVG image, crosswords are placed one under another
+class SvgCrossWriter: public CrossWriter {
+protected:
+    int            _cellSize;
+    bool           _showAnswers;
+    size_t         _width;
+    size_t         _height;
+    std::streamoff _sizePos; // position of size placeholder, -1 if stream isn't seekable
+
+    void putXmlText(char32_t ch);
+
+public:
+    static const int GAP_CELLS = 1; // space between crosswords
+
+    SvgCrossWriter(std::ostream &out, int cell_size = 32, bool show_answers = true):
+        CrossWriter(out), _cellSize(cell_size), _showAnswers(show_answers),
+        _width(0), _height(0), _sizePos(-1) {}
+
+    void begin();
+    void write(const FilledCrossword &cross);
+    void end();
+};
+
+// One PNG image, crosswords are placed one under another like in SVG. Image
+// is compressed when all crosswords are known, so they are kept till end()
+class PngCrossWriter: public CrossWriter {
+protected:
+    ImageOptions              _opts;
+    std::vector< CrossImage > _images;
+
+public:
+    static const int GAP_CELLS = 1;
+
+    PngCrossWriter(std::ostream &out, const ImageOptions &opts = ImageOptions()):
+        CrossWriter(out), _opts(opts) {}
+
+    void write(const FilledCrossword &cross);
+    void end();
+};
+
+std::unique_ptr<CrossWriter> makeCrossWriter(ExportFormat format, std::ostream &out,
+    const ExportTitles &titles = ExportTitles(), const ImageOptions &image_opts = ImageOptions());
 
-wxString getQuesString(const FilledCrossword &cross);
+// Writes crossword to new file in UTF-8. Returns false if file exists or
+// cannot be written
+bool exportToFile(const FilledCrossword &cross, const std::string &path,
+    const ExportTitles &titles = ExportTitles(), ExportFormat format = ExportFormat::Text);
 
-void exportToString(const FilledCrossword &cross, wxString &str_out, wxChar space);
+// Writes all crosswords to one file, existing file is overwritten
+bool exportToFile(const std::vector<FilledCrossword> &crosses, const std::string &path,
+    ExportFormat format, const ExportTitles &titles = ExportTitles(),
+    const ImageOptions &image_opts = ImageOptions());
 
-bool exportToFile(const FilledCrossword &cross, const wxString &path);
+// Writes every crossword to its own image path_prefix<number>.svg or .png,
+// numbers start from 1. Images are drawn by threads (0 - one per core), files
+// are overwritten. Returns false if some file cannot be written
+bool exportImages(const std::vector<FilledCrossword> &crosses, const std::string &path_prefix,
+    ExportFormat format, const ImageOptions &opts = ImageOptions(), size_t threads = 0);
 
 #endif // CROSSEXPORT_HPP
@@ -1,63 +1,81 @@
 #include "crossgen.hpp"
+#include "crosslocal.hpp"
+#include "crosstrace.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <numeric>
+#include <unordered_map>
 //TODO: fix crash when genereates crossword in debug mode with floating-point error
 
-const wxChar      CELL_CLEAR     = wxT('+');
-const wxChar      CELL_BORDER    = wxT('-');
-const TransedChar TRANS_CLEAR    = 0;
-const TransedChar TRANS_BORDER   = 1;
-const uint32_t    MAX_WORD_COUNT = 262144; // =2^18
-
-void readDict(const wxString &path, DictType &dict_out){
-    wxTextFile f;
-    f.Open(path);
-    for (wxString str = f.GetFirstLine(); !f.Eof(); str = f.GetNextLine()) {
-        int del_ind = str.Index('-');
-        wxString key = str.Left(del_ind-1);
-        wxString val = str.Right(str.size() - del_ind - 2);
-        dict_out.insert(std::make_pair(key,val));
-    }
-    f.Close();
-};
+const char32_t    CELL_CLEAR         = U'+';
+const char32_t    CELL_BORDER        = U'-';
+const TransedChar TRANS_CLEAR        = 0;
+const TransedChar TRANS_BORDER       = 1;
+const size_t      MAX_NARROW_LETTERS = 254;   // =2^8  - 2
+const size_t      MAX_WIDE_LETTERS   = 65534; // =2^16 - 2
 
-void readGrid(const wxString &path, GridType &grid){
-    wxTextFile f;
-    f.Open(path);
-    wxString str = f.GetFirstLine();
-    
-    grid.resize(str.size());
-    for (unsigned int i = 0; i < grid.size(); ++i)
-        grid.at(i).resize(f.GetLineCount());
-        
-    wxLogDebug(wxT("Total lines: %d. First line is %s and size = %d"),f.GetLineCount(), str.c_str(),str.size());
-    for (unsigned int i = 0; !f.Eof(); str = f.GetNextLine()){
-        wxLogDebug(str);
-        for (unsigned int j = 0; j < str.size(); ++j)
-            grid.at(j).at(i) = str.at(j);
-        ++i;
-    }
+const WordIndex SearchFrame::NO_WORD;
+const uint32_t CharsTransType::NO_CODE;
+const size_t   CharsTransType::PAGE_BITS;
+const size_t   CharsTransType::PAGE_SIZE;
 
-    wxLogDebug(wxT("Grid with size %2d x %2d is readden"), 
-      static_cast<int>(grid.size()), static_cast<int>(grid.at(0).size()));
-    f.Close();
+bool readDict(const std::string &path, DictType &dict_out){
+    TraceScope trace("readDict");
+    std::ifstream f(path);
+    if ( !f )
+        return false;
+    // Delimiter is ASCII, so line can be split without decoding of UTF-8
+    const std::string DELIM = " - ";
+    std::string line;
+    while ( readLine(f, line) ) {
+        size_t del_ind = line.find(DELIM);
+        if ( del_ind == std::string::npos )
+            continue;
+        size_t clue_ind = del_ind + DELIM.size();
+        DictEntry entry;
+        entry.word = dict_out.text->intern(line.data(), del_ind);
+        entry.clue = dict_out.text->intern(line.data() + clue_ind, line.size() - clue_ind);
+        dict_out.entries.push_back(entry);
+    }
+    dict_out.text->finish();
+    return true;
 }
 
-wxString getFromTransed(const TransedWord &tw, const BackedCharsTransType &bchar_trans){
-    wxString s;
-    s.resize(tw.size());
-    for (size_t i = 0; i < tw.size(); ++i){
-        s[i] = bchar_trans.at(tw.at(i));
+bool readGrid(const std::string &path, GridType &grid){
+    std::ifstream f(path);
+    if ( !f )
+        return false;
+    std::vector< std::u32string > lines;
+    std::string line;
+    while ( readLine(f, line) )
+        lines.push_back(fromUtf8(line));
+    while ( !lines.empty() && lines.back().empty() )
+        lines.pop_back();
+    if ( lines.empty() )
+        return false;
+    
+    grid.resize(lines.at(0).size());
+    for (unsigned int i = 0; i < grid.size(); ++i)
+        grid.at(i).resize(lines.size());
+        
+    crossLogDebug("Total lines: %zu. First line is %s and size = %zu",
+        lines.size(), toUtf8(lines.at(0)).c_str(), lines.at(0).size());
+    for (unsigned int i = 0; i < lines.size(); ++i){
+        crossLogDebug("%s", toUtf8(lines.at(i)).c_str());
+        for (unsigned int j = 0; j < lines.at(i).size() && j < grid.size(); ++j)
+            grid.at(j).at(i) = lines.at(i).at(j);
     }
-    return s;
-}
 
-BackedCharsTransType getFromCharsTransed(const CharsTransType &char_trans){
-    BackedCharsTransType t;
-    for (auto it = char_trans.begin(); it != char_trans.end(); ++it)
-        t[it->second] = it->first;
-    return t;
+    crossLogDebug("Grid with size %2zu x %2zu is readden", grid.size(), grid.at(0).size());
+    return true;
 }
 
-void toWorkGridType(const GridType &grid, WorkGridType &grid_out){
+template <class TChar>
+void toWorkGridType(const GridType &grid, WorkGridT<TChar> &grid_out){
     grid_out.resize(grid.size());
     for (size_t i = 0; i < grid.size(); ++i){
         grid_out.at(i).resize(grid.at(0).size());
@@ -70,133 +88,585 @@ void toWorkGridType(const GridType &grid, WorkGridType &grid_out){
     }
 }
 
-//TODO: new function works very bad with Russian dictionary
-void generateAllWords(const DictType &dict, AllWordsType &words_out, 
-        CharsTransType &char_trans_out){
+// Distinct word of dictionary which isn't translated yet, its clues are
+// already in ClueIndex::clues of its length
+struct RawWord {
+    StrRef    word;
+    ClueRange clues;
+};
+
+// Words of lengths which aren't prepared yet, words of every length are in
+// alphabetical order
+struct DictSource {
+    std::mutex                             mutex;    // every length is prepared under it
+    std::shared_ptr< const StringArena >   text;
+    std::vector< std::vector< RawWord > >  raw;      // by length, freed when length is prepared
+    std::vector< bool >                    prepared; // by length
+};
+
+// Groups lines with equal words, gives codes to all letters and counts their
+// frequencies. Words of every length are put to source, buckets stay empty
+static void indexDict(const DictType &dict, PreparedDict &dict_out){
+    TraceScope trace("indexDict");
+    AllWordsType   &words_out      = dict_out.words;
+    CharsTransType &char_trans_out = dict_out.trans;
+    ClueIndex      &clues_out      = dict_out.clues;
     words_out.clear();
     char_trans_out.clear();
-    char_trans_out[CELL_CLEAR]  = TRANS_CLEAR;
-    char_trans_out[CELL_BORDER] = TRANS_BORDER;
+    clues_out.clear();
+    dict_out.scorer = WordScorer();
+    // Codes are given one by one, so cells get TRANS_CLEAR and TRANS_BORDER
+    char_trans_out.add(CELL_CLEAR);
+    char_trans_out.add(CELL_BORDER);
+    static_assert(TRANS_CLEAR == 0, "TRANS_CLEAR != 0");
     static_assert(TRANS_CLEAR + 1 == TRANS_BORDER, "TRANS_CLEAR + 1 != TRANS_BORDER");
     
-    
-    std::map<wxChar,size_t> freqs;
-    size_t                  char_cnt = 0;
-    std::vector< wxChar >   freqs_sorted; // Contains letters sorted by newest frequency
-    for (auto it = dict.begin(); it != dict.end(); ++it){
-        for (auto cht = it->first.begin(); cht != it->first.end(); ++cht){
-            if ( freqs.find(*cht) != freqs.end() )
-                freqs[*cht] += 1;
-            else
-                freqs[*cht] = 1;
-            ++char_cnt;
+    // Lines with equal words are grouped, words are in alphabetical order
+    const StringArena &text = *dict.text;
+    std::vector< uint32_t > order(dict.entries.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&dict, &text](uint32_t a, uint32_t b){
+        return text.compare(dict.entries[a].word, dict.entries[b].word) < 0;
+    });
+    auto source = std::make_shared<DictSource>();
+    source->text = dict.text;
+    // Every line of dictionary is counted like before grouping
+    std::vector< size_t > counts; // by code of letter
+    std::vector< std::vector< StrRef > > clues; // by length
+    std::u32string word;
+    for (size_t i = 0; i < order.size(); ){
+        RawWord rw;
+        rw.word = dict.entries[order[i]].word;
+        word    = text.get(rw.word);
+        if ( clues.size() <= word.size() )
+            clues.resize(word.size() + 1);
+        std::vector< StrRef > &len_clues = clues[word.size()];
+        rw.clues.first = static_cast<uint32_t>(len_clues.size());
+        for (; (i < order.size()) && (text.compare(dict.entries[order[i]].word, rw.word) == 0); ++i)
+            len_clues.push_back(dict.entries[order[i]].clue);
+        rw.clues.last  = static_cast<uint32_t>(len_clues.size());
+        // New letters get next codes
+        for (auto ch: word){
+            uint32_t code = char_trans_out.add(ch);
+            if ( counts.size() <= code )
+                counts.resize(code + 1, 0);
+            counts[code] += rw.clues.last - rw.clues.first;
         }
+        if ( source->raw.size() <= word.size() )
+            source->raw.resize(word.size() + 1);
+        source->raw[word.size()].push_back(rw);
     }
     
-    for (auto i: freqs)
-        freqs_sorted.push_back(i.first);
-
-    std::sort(freqs_sorted.begin(),freqs_sorted.end(), 
-        [freqs](wxChar val1, wxChar val2) { return freqs.at(val1) > freqs.at(val2);});
+    WordScorer &scorer = dict_out.scorer;
+    for (size_t code = 0; code < counts.size(); ++code){
+        if ( counts[code] == 0 )
+            continue;
+        scorer.freqs[char_trans_out.letter(code)] = counts[code];
+        scorer.char_cnt += counts[code];
+    }
+    const std::map<char32_t,size_t> &freqs = scorer.freqs;
         
     #ifndef NDEBUG
-        wxLogDebug(wxT("Printing list of sorted letters:"));
+        crossLogDebug("Printing list of sorted letters:");
         for (auto i: freqs)
-            wxLogDebug(wxT("Freq of ") + wxString(i.first) + wxT(" is %5d"), i.second);
+            crossLogDebug("Freq of %s is %5zu", toUtf8(i.first).c_str(), i.second);
     #endif
     
-    // Function returns -1 if this word is so bad to include to dict
-    // else return points for scoreng. More = better
-    // TODO: improve formula
-    std::function< int(const wxString& ) > getWordScore = [freqs, freqs_sorted, char_cnt]
-        (const wxString &s) -> int{
-            double score = 1;
-            for (auto ch: s)
-                score *= static_cast<double>(freqs.at(ch))/char_cnt;
-            // static_cast<double>(freqs.at(ch))/char_cnt = normalaised frequency
-            
-            // euristic fomula for good (not normal)
-            
-            score = std::pow(score, 1./s.size()); // score == mean geometric
-            /* magic formula, linear interpolation from good numbers
-             * can be taken from Maxima code:
-             * solve ([33*k+m = 1/20.4, 26*k+m=1/19],[k,m]);
-             */
-            if ( score > 64./969 - freqs.size()*1./1938 )
-            //if ( score > (1.3)* 1./(freqs.size() - 8))
-                return static_cast<int>(score * 1000);
-            else
-                return -1;
-        };
+    if ( freqs.size() > MAX_WIDE_LETTERS )
+        throw std::length_error("Too many letters in dictionary");
     
-    TransedChar st = TRANS_BORDER + 1;
-    for (auto it = dict.begin(); it != dict.end(); ++it){
-        if ( words_out.size() <= it->first.size() )
-            words_out.resize(it->first.size() + 1);
-        
-        if ( getWordScore(it->first) == -1 )
+    // Letters of 8-bit alphabet are faster, so it is used if possible
+    words_out.wide = freqs.size() > MAX_NARROW_LETTERS;
+    crossLogDebug("Alphabet has %zu letters, using %d-bit words", 
+        freqs.size(), words_out.wide ? 16 : 8);
+    // All buckets are made at once, so preparing of one length doesn't move others
+    const size_t lens = source->raw.size();
+    if ( words_out.wide )
+        words_out.wide_words.resize(lens);
+    else
+        words_out.narrow_words.resize(lens);
+    words_out.scores.resize(lens);
+    clues_out.ranges.resize(lens);
+    clues_out.clues.resize(lens);
+    for (size_t len = 0; len < clues.size(); ++len)
+        clues_out.clues[len] = SharedVector< StrRef >(std::move(clues[len]));
+    clues_out.text = dict.text;
+    source->prepared.assign(lens, false);
+    dict_out.source = source;
+}
+
+// Translates good words of length len to alphabet with letters of type TChar
+// and sorts them from best words to worst ones. Clues of word get the same
+// place in clues.ranges as word in words
+template <class TChar>
+static void prepareLengthT(const PreparedDict &dict, const DictSource &source, size_t len,
+        WordsStorageT<TChar> &words, WordsDawgsT<TChar> &dawgs){
+    // Score is counted once per word, not on every comparison while sorting
+    struct ScoredWord {
+        int                 score;
+        TransedWordT<TChar> word;
+        ClueRange           clues;
+    };
+    std::vector< ScoredWord > bucket;
+    bucket.reserve(source.raw[len].size());
+    for (auto &rw: source.raw[len]){
+        std::u32string word = source.text->get(rw.word);
+        int score = dict.scorer(word);
+        if ( score == -1 )
             continue;
         
-        TransedWord t_tw(it->first.size());
-        for (size_t i = 0; i < it->first.size(); ++i){
-            auto cur_ch = it->first.at(i);
-            if ( char_trans_out.find(cur_ch) == char_trans_out.end() ){
-                char_trans_out[cur_ch] = st;
-                ++st;
-            }
-            t_tw.at(i) = char_trans_out[cur_ch];
+        ScoredWord sw;
+        sw.score = score;
+        sw.word.resize(len);
+        for (size_t i = 0; i < len; ++i)
+            sw.word[i] = static_cast<TChar>(dict.trans.code(word[i]));
+        sw.clues = rw.clues;
+        bucket.push_back(std::move(sw));
+    }
+    
+    // sorting of words with good order <=> scores(i) > scores(i+1)
+    std::stable_sort(bucket.begin(), bucket.end(),
+        [](const ScoredWord &a, const ScoredWord &b){
+            return a.score > b.score;
         }
-        words_out.at(it->first.size()).push_back(t_tw);
+    );
+    std::vector< TransedWordT<TChar> > bucket_words;
+    std::vector< int >                 scores;
+    std::vector< ClueRange >           ranges;
+    bucket_words.reserve(bucket.size());
+    scores.reserve(bucket.size());
+    ranges.reserve(bucket.size());
+    for (auto &sw: bucket){
+        bucket_words.push_back(std::move(sw.word));
+        scores.push_back(sw.score);
+        ranges.push_back(sw.clues);
+    }
+    words.at(len)             = SharedVector< TransedWordT<TChar> >(std::move(bucket_words));
+    dict.words.scores.at(len) = SharedVector< int >(std::move(scores));
+    dict.clues.ranges.at(len) = SharedVector< ClueRange >(std::move(ranges));
+    if ( !dawgs.empty() )
+        dawgs.at(len).build(words.at(len));
+    crossLogDebug("With length %2zu is %5zu and after it %4zu",
+        len, source.raw[len].size(), words.at(len).size());
+}
+
+// Lock of source is held by caller
+static void prepareLength(const PreparedDict &dict, DictSource &source, size_t len){
+    if ( (len >= source.prepared.size()) || source.prepared[len] )
+        return;
+    TraceScope trace("prepareLength");
+    if ( dict.words.wide )
+        prepareLengthT(dict, source, len, dict.words.wide_words, dict.words.wide_dawgs);
+    else
+        prepareLengthT(dict, source, len, dict.words.narrow_words, dict.words.narrow_dawgs);
+    source.prepared[len] = true;
+    std::vector< RawWord >().swap(source.raw[len]);
+}
+
+// TODO: improve formula
+int WordScorer::operator()(const std::u32string &s) const{
+    double score = 1;
+    for (auto ch: s){
+        // static_cast<double>(freqs.at(ch))/char_cnt = normalaised frequency
+        auto it = freqs.find(ch);
+        if ( it == freqs.end() )
+            return -1;
+        score *= static_cast<double>(it->second)/char_cnt;
     }
     
-    auto bctt = getFromCharsTransed(char_trans_out);
+    // euristic fomula for good (not normal)
     
-    // sorting of words with good order <=> scores(i) > scores(i+1)
-    for (unsigned int i = 2; i < words_out.size(); ++i)
-        std::sort(words_out.at(i).begin(),words_out.at(i).end(),
-            [getWordScore, bctt](const TransedWord &a, const TransedWord &b){
-                return getWordScore(getFromTransed(a, bctt)) > getWordScore(getFromTransed(b, bctt));
-            }
-        );
+    score = std::pow(score, 1./s.size()); // score == mean geometric
+    /* magic formula, linear interpolation from good numbers
+     * can be taken from Maxima code:
+     * solve ([33*k+m = 1/20.4, 26*k+m=1/19],[k,m]);
+     */
+    if ( score > 64./969 - freqs.size()*1./1938 )
+    //if ( score > (1.3)* 1./(freqs.size() - 8))
+        return static_cast<int>(score * 1000);
+    else
+        return -1;
+}
+
+//TODO: new function works very bad with Russian dictionary
+void generateAllWords(const DictType &dict, AllWordsType &words_out, 
+        CharsTransType &char_trans_out, ClueIndex &clues_out, WordScorer &scorer_out){
+    TraceScope trace("generateAllWords");
+    PreparedDict prepared;
+    indexDict(dict, prepared);
+    prepareDictLengths(prepared);
+    words_out      = std::move(prepared.words);
+    char_trans_out = std::move(prepared.trans);
+    clues_out      = std::move(prepared.clues);
+    scorer_out     = std::move(prepared.scorer);
+}
+
+bool loadDict(const std::string &path, PreparedDict &dict_out, bool lazy){
+    dict_out.words.clear();
+    dict_out.trans.clear();
+    dict_out.clues.clear();
+    dict_out.scorer = WordScorer();
+    dict_out.source.reset();
+    // Only arena of dictionary is kept, it is shared with dict_out.clues
+    DictType dict;
+    if ( !readDict(path, dict) )
+        return false;
+    indexDict(dict, dict_out);
+    if ( !lazy )
+        prepareDictLengths(dict_out);
+    return true;
+}
+
+void prepareDictLengths(const PreparedDict &dict, const CompiledGrid &cgrid){
+    if ( !dict.source )
+        return;
+    std::lock_guard< std::mutex > lock(dict.source->mutex);
+    for (auto &wi: cgrid.winfos)
+        prepareLength(dict, *dict.source, wi.len);
+}
+
+void prepareDictLengths(const PreparedDict &dict){
+    if ( !dict.source )
+        return;
+    std::lock_guard< std::mutex > lock(dict.source->mutex);
+    for (size_t len = 0; len < dict.source->prepared.size(); ++len)
+        prepareLength(dict, *dict.source, len);
+}
+
+template <class TChar>
+static void buildWordsDawgsT(const WordsStorageT<TChar> &words, WordsDawgsT<TChar> &dawgs_out){
+    dawgs_out.clear();
+    dawgs_out.resize(words.size());
+    for (size_t i = 1; i < words.size(); ++i)
+        dawgs_out[i].build(words[i]);
+}
+
+void buildWordsDawgs(AllWordsType &words){
+    TraceScope trace("buildWordsDawgs");
+    if ( words.wide )
+        buildWordsDawgsT(words.wide_words, words.wide_dawgs);
+    else
+        buildWordsDawgsT(words.narrow_words, words.narrow_dawgs);
+}
+
+// One line of delta file
+struct DeltaLine {
+    char           op;
+    std::u32string word;
+    std::string    clue; // in UTF-8 like in arena
+    bool           has_clue;
+};
+
+static bool readDelta(const std::string &path, std::vector<DeltaLine> &lines_out){
+    std::ifstream f(path);
+    if ( !f )
+        return false;
+    const std::string DELIM = " - ";
+    std::string line;
+    while ( readLine(f, line) ) {
+        if ( line.empty() || ((line[0] != '+') && (line[0] != '-') && (line[0] != '=')) )
+            continue;
+        DeltaLine dl;
+        dl.op = line[0];
+        size_t del_ind = line.find(DELIM, 1);
+        dl.has_clue = del_ind != std::string::npos;
+        if ( dl.has_clue ) {
+            dl.word = fromUtf8(line.substr(1, del_ind - 1));
+            dl.clue = line.substr(del_ind + DELIM.size());
+        } else if ( dl.op == '-' ) {
+            dl.word = fromUtf8(line.substr(1));
+        } else {
+            continue;
+        }
+        if ( !dl.word.empty() )
+            lines_out.push_back(std::move(dl));
+    }
+    return true;
+}
+
+// FNV-1a of translated word
+template <class TChar>
+static size_t hashTransedWord(const TransedWordT<TChar> &w){
+    uint64_t h = 14695981039346656037ULL;
+    for (auto ch: w) {
+        h ^= static_cast<uint64_t>(ch);
+        h *= 1099511628211ULL;
+    }
+    return static_cast<size_t>(h);
+}
+
+// Changes of one length bucket, the bucket is rebuilt once after all lines.
+// Old words keep their indexes as places, added words get places after them
+template <class TChar>
+struct BucketDelta {
+    std::unordered_multimap< size_t, uint32_t > places; // hash of word -> place, without removed words
+    std::vector< TransedWordT<TChar> >          added;
+    std::vector< int >                          added_scores;
+    std::vector< bool >                         removed;  // by place
+    std::map< uint32_t, std::vector<StrRef> >   clues;    // changed clues by place
+    std::set< uint32_t >                        replaced; // places of words of = lines
+    bool                                        changed;
+    bool                                        words_changed; // words are added or removed
     
-    #ifndef NDEBUG
-        wxLogDebug(wxT("%d -> %d"),getWordScore(getFromTransed(words_out.at(5).at(2), bctt)),getWordScore(getFromTransed(words_out.at(5).at(400), bctt)));
-        AllWordsType words_out_t;
-        st = TRANS_BORDER + 1;
-        for (auto it = dict.begin(); it != dict.end(); ++it){
-            if ( words_out_t.size() <= it->first.size() )
-                words_out_t.resize(it->first.size() + 1);
-            
-            TransedWord t_tw(it->first.size());
-            for (size_t i = 0; i < it->first.size(); ++i){
-                auto cur_ch = it->first.at(i);
-                if ( char_trans_out.find(cur_ch) == char_trans_out.end() ){
-                    char_trans_out[cur_ch] = st;
-                    ++st;
+    BucketDelta(): changed(false), words_changed(false) {}
+};
+
+template <class TChar>
+static void applyDeltaT(const std::vector<DeltaLine> &lines, PreparedDict &dict,
+        StringArena &text, WordsStorageT<TChar> &words, WordsDawgsT<TChar> &dawgs){
+    auto &scores = dict.words.scores;
+    auto &ranges = dict.clues.ranges;
+    auto &clues  = dict.clues.clues;
+    std::map< size_t, BucketDelta<TChar> > deltas; // by length, only lengths of lines
+    
+    auto oldCount = [&words](size_t len) {
+        return len < words.size() ? words[len].size() : 0;
+    };
+    auto wordAt = [&](const BucketDelta<TChar> &bd, size_t len, uint32_t place) -> const TransedWordT<TChar>& {
+        return place < oldCount(len) ? words[len][place] : bd.added[place - oldCount(len)];
+    };
+    // Clues of word before current line
+    auto getClues = [&](const BucketDelta<TChar> &bd, size_t len, uint32_t place,
+            std::vector<StrRef> &clues_out) {
+        auto it = bd.clues.find(place);
+        if ( it != bd.clues.end() ) {
+            clues_out = it->second;
+        } else if ( place < oldCount(len) ) {
+            const ClueRange &r = ranges[len][place];
+            clues_out.assign(clues[len].begin() + r.first, clues[len].begin() + r.last);
+        } else {
+            clues_out.clear();
+        }
+    };
+    auto findClue = [&text](const std::vector<StrRef> &refs, const std::string &clue) {
+        for (size_t k = 0; k < refs.size(); ++k)
+            if ( (refs[k].len == clue.size()) && (text.getUtf8(refs[k]) == clue) )
+                return k;
+        return refs.size();
+    };
+    
+    TransedWordT<TChar> tw;
+    std::vector<StrRef> old_clues, new_clues;
+    for (auto &dl: lines) {
+        const size_t len = dl.word.size();
+        tw.resize(len);
+        bool known = true;
+        for (size_t j = 0; (j < len) && known; ++j) {
+            uint32_t code = dict.trans.code(dl.word[j]);
+            known = code != CharsTransType::NO_CODE;
+            tw[j] = static_cast<TChar>(code);
+        }
+        if ( !known )
+            continue; // word with unknown letter cannot be removed
+        
+        // Bucket is indexed by hashes on its first line, it is faster than
+        // search of every word and bucket is copied anyway
+        auto ins = deltas.insert(std::make_pair(len, BucketDelta<TChar>()));
+        BucketDelta<TChar> &bd = ins.first->second;
+        if ( ins.second ) {
+            bd.places.reserve(oldCount(len));
+            for (size_t i = 0; i < oldCount(len); ++i)
+                bd.places.insert(std::make_pair(hashTransedWord(words[len][i]), static_cast<uint32_t>(i)));
+            bd.removed.assign(oldCount(len), false);
+        }
+        const size_t h     = hashTransedWord(tw);
+        auto         range = bd.places.equal_range(h);
+        auto         found = range.first;
+        while ( (found != range.second) && (wordAt(bd, len, found->second) != tw) )
+            ++found;
+        const bool exists = found != range.second;
+        uint32_t   place  = exists ? found->second : 0;
+        
+        if ( dl.op == '-' ) {
+            if ( !exists )
+                continue;
+            if ( dl.has_clue ) {
+                getClues(bd, len, place, old_clues);
+                const size_t cnt = old_clues.size();
+                old_clues.erase(std::remove_if(old_clues.begin(), old_clues.end(),
+                    [&text, &dl](StrRef ref){
+                        return (ref.len == dl.clue.size()) && (text.getUtf8(ref) == dl.clue);
+                    }), old_clues.end());
+                if ( old_clues.size() == cnt )
+                    continue;
+                bd.changed = true;
+                if ( !old_clues.empty() ) {
+                    bd.clues[place] = old_clues;
+                    continue;
                 }
-                t_tw.at(i) = char_trans_out[cur_ch];
             }
-            words_out_t.at(it->first.size()).push_back(t_tw);
+            bd.removed[place] = true;
+            bd.clues.erase(place);
+            bd.places.erase(found);
+            bd.changed       = true;
+            bd.words_changed = true;
+            continue;
         }
         
-        for (unsigned int i = 2; i < words_out.size(); ++i)
-            wxLogDebug(wxT("With length %2d is %5d and after it %4d and coeff is %2.2f"), 
-                i, words_out_t.at(i).size(), words_out.at(i).size(), float(words_out_t.at(i).size())/words_out.at(i).size());
+        if ( !exists ) {
+            place = static_cast<uint32_t>(oldCount(len) + bd.added.size());
+            bd.added.push_back(tw);
+            bd.added_scores.push_back(std::max(dict.scorer(dl.word), 0));
+            bd.removed.push_back(false);
+            bd.places.insert(std::make_pair(h, place));
+            bd.words_changed = true;
+        }
+        getClues(bd, len, place, old_clues);
+        // The first = line of word drops its clues. Text of clue which word
+        // has had is reused, text of other ones is interned
+        if ( (dl.op == '=') && bd.replaced.insert(place).second )
+            new_clues.clear();
+        else
+            new_clues = old_clues;
+        if ( findClue(new_clues, dl.clue) == new_clues.size() ) {
+            size_t k = findClue(old_clues, dl.clue);
+            new_clues.push_back(k < old_clues.size() ? old_clues[k] :
+                text.intern(dl.clue.data(), dl.clue.size()));
+        }
+        bd.clues[place] = new_clues;
+        bd.changed      = true;
+    }
+    
+    size_t lens = words.size();
+    for (auto &it: deltas)
+        lens = std::max(lens, it.first + 1);
+    words.resize(lens);
+    scores.resize(lens);
+    ranges.resize(lens);
+    clues.resize(lens);
+    if ( !dawgs.empty() )
+        dawgs.resize(lens);
+    
+    // Changed buckets are merged with their added words, added ones go after
+    // old words with the same score like after stable sorting. Other buckets
+    // stay shared with base, words of bucket with changed clues only too
+    for (auto &it: deltas) {
+        const size_t        len = it.first;
+        BucketDelta<TChar> &bd  = it.second;
+        if ( !bd.changed )
+            continue;
+        const size_t old_cnt = bd.removed.size() - bd.added.size();
+        std::vector<uint32_t> added(bd.added.size());
+        std::iota(added.begin(), added.end(), 0);
+        std::stable_sort(added.begin(), added.end(), [&bd](uint32_t a, uint32_t b){
+            return bd.added_scores[a] > bd.added_scores[b];
+        });
         
-        wxLogDebug(wxT("Number of words is %d"), dict.size());
-        int cur_s = std::accumulate(words_out.begin(),words_out.end(), 0, []
-            (int &s, std::vector< TransedWord > &add) { return s+add.size(); });
-        wxLogDebug(wxT("Current size is %d"), cur_s);
-    #endif
+        std::vector< TransedWordT<TChar> > len_words;
+        std::vector< int >                 len_scores;
+        std::vector< ClueRange >           len_ranges;
+        std::vector< StrRef >              len_clues;
+        if ( bd.words_changed ) {
+            len_words.reserve(bd.removed.size());
+            len_scores.reserve(bd.removed.size());
+        }
+        len_ranges.reserve(bd.removed.size());
+        size_t i = 0, k = 0;
+        while ( (i < old_cnt) || (k < added.size()) ) {
+            bool is_old = (i < old_cnt) &&
+                ((k == added.size()) || (scores[len][i] >= bd.added_scores[added[k]]));
+            uint32_t place = static_cast<uint32_t>(is_old ? i++ : old_cnt + added[k++]);
+            if ( bd.removed[place] )
+                continue;
+            ClueRange r;
+            r.first = static_cast<uint32_t>(len_clues.size());
+            auto c = bd.clues.find(place);
+            if ( c != bd.clues.end() ) {
+                len_clues.insert(len_clues.end(), c->second.begin(), c->second.end());
+            } else {
+                const ClueRange &old_r = ranges[len][place];
+                len_clues.insert(len_clues.end(), clues[len].begin() + old_r.first,
+                    clues[len].begin() + old_r.last);
+            }
+            r.last = static_cast<uint32_t>(len_clues.size());
+            len_ranges.push_back(r);
+            if ( !bd.words_changed ) {
+                continue;
+            } else if ( is_old ) {
+                len_words.push_back(words[len][place]);
+                len_scores.push_back(scores[len][place]);
+            } else {
+                len_words.push_back(std::move(bd.added[place - old_cnt]));
+                len_scores.push_back(bd.added_scores[place - old_cnt]);
+            }
+        }
+        ranges[len] = SharedVector< ClueRange >(std::move(len_ranges));
+        clues[len]  = SharedVector< StrRef >(std::move(len_clues));
+        if ( !bd.words_changed )
+            continue;
+        words[len]  = SharedVector< TransedWordT<TChar> >(std::move(len_words));
+        scores[len] = SharedVector< int >(std::move(len_scores));
+        if ( !dawgs.empty() )
+            dawgs[len].build(words[len]);
+    }
+}
+
+bool applyDictDelta(const PreparedDict &base, const std::string &path, PreparedDict &dict_out){
+    TraceScope trace("applyDictDelta");
+    std::vector<DeltaLine> lines;
+    if ( !readDelta(path, lines) )
+        return false;
+    prepareDictLengths(base);
+    // Buckets, clues and automatons are shared with base until delta changes them
+    dict_out = base;
+    dict_out.source.reset();
+    if ( dict_out.trans.empty() ) {
+        dict_out.trans.add(CELL_CLEAR);
+        dict_out.trans.add(CELL_BORDER);
+    }
+    
+    // New letters get next codes, so old words keep their translation
+    for (auto &dl: lines) {
+        if ( dl.op == '-' )
+            continue;
+        for (auto ch: dl.word) {
+            if ( dict_out.trans.contains(ch) )
+                continue;
+            if ( dict_out.trans.size() - 2 >= MAX_WIDE_LETTERS )
+                throw std::length_error("Too many letters in dictionary");
+            dict_out.trans.add(ch);
+        }
+    }
+    
+    AllWordsType &words = dict_out.words;
+    if ( !words.wide && (dict_out.trans.size() - 2 > MAX_NARROW_LETTERS) ) {
+        // Codes of 8-bit alphabet are the same in 16-bit one, all buckets are copied
+        crossLogDebug("Delta has too many new letters, switching to 16-bit words");
+        words.wide_words.resize(words.narrow_words.size());
+        for (size_t i = 0; i < words.narrow_words.size(); ++i) {
+            std::vector< TransedWordT<WideTransedChar> > bucket;
+            bucket.reserve(words.narrow_words[i].size());
+            for (auto &tw: words.narrow_words[i])
+                bucket.push_back(TransedWordT<WideTransedChar>(tw.begin(), tw.end()));
+            words.wide_words[i] = SharedVector< TransedWordT<WideTransedChar> >(std::move(bucket));
+        }
+        words.narrow_words.clear();
+        words.wide = true;
+        if ( !words.narrow_dawgs.empty() ) {
+            words.narrow_dawgs.clear();
+            buildWordsDawgsT(words.wide_words, words.wide_dawgs);
+        }
+    }
+    
+    // Arena of base is read by its users, so new clues go to layer over it.
+    // Layer keeps its table of interned clues, so next deltas reuse them
+    auto text = base.clues.text ? std::make_shared<StringArena>(base.clues.text) :
+        std::make_shared<StringArena>();
+    if ( words.wide )
+        applyDeltaT(lines, dict_out, *text, words.wide_words, words.wide_dawgs);
+    else
+        applyDeltaT(lines, dict_out, *text, words.narrow_words, words.narrow_dawgs);
+    dict_out.clues.text = text;
+    return true;
 }
 
 void generateWordInfo(const GridType &grid, std::vector<WordInfo> &winfos_out){
-    wxLogDebug(wxT("Printing grid: "));
+    crossLogDebug("Printing grid: ");
     for (size_t i = 0; i < grid.size(); ++i){
-        wxString st;
+        std::u32string st;
         for (size_t j = 0; j < grid.at(0).size(); ++j)
             st += grid.at(i).at(j);
-        wxLogDebug(st);
+        crossLogDebug("%s", toUtf8(st).c_str());
     }
     size_t cur_ind = 1;
     bool exist = false;
@@ -258,83 +728,1096 @@ void generateWordInfo(const GridType &grid, std::vector<WordInfo> &winfos_out){
     }
 }
 
+template <class TChar>
+void SearchScratch<TChar>::prepare(const WordsStorageT<TChar> &words, size_t depth){
+    used.resize(words.size());
+    for (size_t i = 0; i < words.size(); ++i)
+        used[i].assign(words[i].size(), 0);
+    if ( cands.size() < depth )
+        cands.resize(depth);
+    if ( patterns.size() < depth )
+        patterns.resize(depth);
+    if ( ranked.size() < depth )
+        ranked.resize(depth);
+    path.resize(depth);
+    frames.resize(depth);
+    this->depth = 0;
+}
+
+template <class TChar>
+size_t SearchScratch<TChar>::memoryUsage() const{
+    size_t res = path.capacity() * sizeof(WordUniq);
+    for (auto &col: grid)
+        res += col.capacity() * sizeof(TChar);
+    for (auto &marks: used)
+        res += marks.capacity();
+    for (auto &c: cands)
+        res += c.capacity() * sizeof(WordIndex);
+    for (auto &pt: patterns)
+        res += pt.capacity() * sizeof(TChar);
+    for (auto &r: ranked)
+        res += r.capacity() * sizeof(uint64_t);
+    for (auto &pt: crossing)
+        res += pt.capacity() * sizeof(TChar);
+    res += frames.capacity() * sizeof(SearchFrame);
+    return res;
+}
+
+template <class TChar>
+struct CrossSearch {
+    const WordsStorageT<TChar>  &words;
+    const WordsDawgsT<TChar>    *dawgs;
+    const std::vector<WordInfo> &winfos;
+    SearchScratch<TChar>        &s;
+    GenerateControl             *ctrl;
+    const CompiledGrid          *cgrid; // crossings for lookahead, slots are in order of winfos
+    uint64_t                    key;    // key of checkpoints, 0 if search isn't checkpointed
+};
+
+// splitmix64, its state is one number, so it is saved to checkpoints
+static inline uint32_t nextSearchRand(uint64_t &state){
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return static_cast<uint32_t>((z ^ (z >> 31)) >> 32);
+}
+
+// Reads n bytes to integer, n is known at compile time. Bytes are read by
+// parts of 4, 2 and 1 and are joined in register: memcpy of 7 bytes to
+// variable makes partial stores, and next load of it stalls
+static inline uint64_t loadBytes(const void *src, size_t n){
+    const uint8_t *p = static_cast<const uint8_t*>(src);
+    if ( n == 8 ) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        return v;
+    }
+    uint64_t res   = 0;
+    size_t   shift = 0;
+    if ( n & 4 ) {
+        uint32_t v;
+        memcpy(&v, p, 4);
+        res    = v;
+        p     += 4;
+        shift  = 32;
+    }
+    if ( n & 2 ) {
+        uint16_t v;
+        memcpy(&v, p, 2);
+        res   |= static_cast<uint64_t>(v) << shift;
+        p     += 2;
+        shift += 16;
+    }
+    if ( n & 1 )
+        res |= static_cast<uint64_t>(*p) << shift;
+    return res;
+}
+
+// Letters of slot packed to 64-bit chunks, word matches slot if its chunks
+// masked by mask are equal to value. Free cells have zero mask.
+// LEN is length of slot, so loops are unrolled and matching of short word is
+// a load, an and and a compare. Kernel with LEN = 0 is for any length
+template <class TChar, size_t LEN>
+struct SlotKernel {
+    static const size_t CHUNK_CHARS = sizeof(uint64_t) / sizeof(TChar);
+    static const size_t CHUNKS      = (LEN + CHUNK_CHARS - 1) / CHUNK_CHARS;
+    
+    uint64_t mask[CHUNKS];
+    uint64_t value[CHUNKS];
+    
+    static uint64_t load(const TChar *w, size_t chunk){
+        const size_t first = chunk * CHUNK_CHARS;
+        const size_t count = std::min(CHUNK_CHARS, LEN - first);
+        return loadBytes(w + first, count * sizeof(TChar));
+    }
+    
+    void setPattern(const TChar *pattern){
+        TChar mask_chars[LEN];
+        TChar value_chars[LEN];
+        for (size_t j = 0; j < LEN; ++j) {
+            bool is_set    = pattern[j] != TRANS_CLEAR;
+            mask_chars[j]  = is_set ? static_cast<TChar>(~TChar(0)) : TChar(0);
+            value_chars[j] = is_set ? pattern[j] : TChar(0);
+        }
+        for (size_t c = 0; c < CHUNKS; ++c) {
+            mask[c]  = load(mask_chars, c);
+            value[c] = load(value_chars, c);
+        }
+    }
+    
+    bool match(const TChar *w) const{
+        for (size_t c = 0; c < CHUNKS; ++c)
+            if ( (load(w, c) & mask[c]) != value[c] )
+                return false;
+        return true;
+    }
+};
+
+template <class TChar, size_t LEN>
+const size_t SlotKernel<TChar, LEN>::CHUNK_CHARS;
+
+template <class TChar>
+struct SlotKernel<TChar, 0> {
+    const TChar *pattern;
+    size_t      len;
+    
+    bool match(const TChar *w) const{
+        for (size_t j = 0; j < len; ++j)
+            if ( (pattern[j] != TRANS_CLEAR) && (pattern[j] != w[j]) )
+                return false;
+        return true;
+    }
+};
+
+template <class TChar, size_t LEN>
+static void initSlotKernel(SlotKernel<TChar, LEN> &k, const TChar *pattern, size_t){
+    k.setPattern(pattern);
+}
+
+template <class TChar>
+static void initSlotKernel(SlotKernel<TChar, 0> &k, const TChar *pattern, size_t len){
+    k.pattern = pattern;
+    k.len     = len;
+}
+
+// Ranks of lookahead are numbers of matching words up to this one
+static const uint32_t LOOKAHEAD_CAP = 256;
+
+// Letters of crossing slots which aren't filled yet are put to s.crossing,
+// pattern is empty if letter j of slot isn't crossed by such slot. Returns
+// false if there is no crossing slot to look at
+template <class TChar>
+static bool prepareLookahead(const CrossSearch<TChar> &cs, size_t slot,
+    const TransedWordT<TChar> &pattern){
+    std::vector< TransedWordT<TChar> > &crossing = cs.s.crossing;
+    if ( crossing.size() < pattern.size() )
+        crossing.resize(pattern.size());
+    bool res = false;
+    for (size_t j = 0; j < pattern.size(); ++j) {
+        crossing[j].clear();
+        const SlotPos &c = cs.cgrid->crossOf(slot, j);
+        // Free letter of slot is crossed only by slot which isn't filled
+        if ( (c.slot == CompiledGrid::NO_SLOT) || (pattern[j] != TRANS_CLEAR) )
+            continue;
+        const WordInfo &wi = cs.winfos[c.slot];
+        if ( (wi.len >= cs.dawgs->size()) || (*cs.dawgs)[wi.len].empty() )
+            continue;
+        crossing[j].resize(wi.len);
+        for (size_t k = 0; k < wi.len; ++k)
+            crossing[j][k] = wi.direct ? cs.s.grid[wi.x + k][wi.y] : cs.s.grid[wi.x][wi.y + k];
+        res = true;
+    }
+    return res;
+}
+
+// Options which word in slot leaves to crossing slots: minimum of their
+// numbers of matching words up to LOOKAHEAD_CAP, 0 is a dead end
+template <class TChar>
+static uint32_t getLookaheadRank(const CrossSearch<TChar> &cs, size_t slot, const TChar *word){
+    uint32_t res = LOOKAHEAD_CAP;
+    for (size_t j = 0; (j < cs.winfos[slot].len) && (res > 0); ++j) {
+        TransedWordT<TChar> &crossing = cs.s.crossing[j];
+        if ( crossing.empty() )
+            continue;
+        TChar &letter = crossing[cs.cgrid->crossOf(slot, j).pos];
+        letter = word[j];
+        res    = static_cast<uint32_t>((*cs.dawgs)[crossing.size()].count(crossing, res));
+        letter = TRANS_CLEAR;
+    }
+    return res;
+}
+
+// Letters of slot are put to its pattern, candidates of slot are found by
+// them. Frame gets no word, its positions are set by caller
+template <class TChar>
+static void openSlot(const CrossSearch<TChar> &cs, size_t slot){
+    const WordInfo      &wi      = cs.winfos[slot];
+    SearchFrame         &f       = cs.s.frames[slot];
+    WorkGridT<TChar>    &grid    = cs.s.grid;
+    TransedWordT<TChar> &pattern = cs.s.patterns[slot];
+    pattern.resize(wi.len);
+    bool is_free = true;
+    for (size_t j = 0; j < wi.len; ++j) {
+        pattern[j] = wi.direct ? grid[wi.x + j][wi.y] : grid[wi.x][wi.y + j];
+        is_free = is_free && (pattern[j] == TRANS_CLEAR);
+    }
+    
+    // Automaton gives only words matching letters which are already in slot,
+    // they are sorted to keep order from best words to worst ones. Every word
+    // matches empty slot, so it is scanned without automaton
+    f.use_dawg   = !is_free && (cs.dawgs != nullptr) && (wi.len < cs.dawgs->size()) &&
+        !(*cs.dawgs)[wi.len].empty();
+    f.need_match = !is_free && !f.use_dawg;
+    std::vector<WordIndex> &cands = cs.s.cands[slot];
+    cands.clear();
+    if ( f.use_dawg ) {
+        (*cs.dawgs)[wi.len].match(pattern, cands);
+        std::sort(cands.begin(), cands.end());
+    }
+    f.count = static_cast<uint32_t>(f.use_dawg ? cands.size() : cs.words[wi.len].size());
+    f.word  = SearchFrame::NO_WORD;
+}
+
+template <class TChar>
+static void placeWord(const CrossSearch<TChar> &cs, size_t slot, WordIndex word){
+    const WordInfo &wi   = cs.winfos[slot];
+    const TChar    *w    = cs.words[wi.len][word].data();
+    WorkGridT<TChar> &grid = cs.s.grid;
+    for (size_t j = 0; j < wi.len; ++j)
+        (wi.direct ? grid[wi.x + j][wi.y] : grid[wi.x][wi.y + j]) = w[j];
+    cs.s.used[wi.len][word] = 1;
+    cs.s.path[slot]         = getWordUniq(word, static_cast<WordIndex>(wi.len));
+    cs.s.frames[slot].word  = word;
+}
+
+// Letters of slot become letters of its pattern again
+template <class TChar>
+static void removeWord(const CrossSearch<TChar> &cs, size_t slot){
+    const WordInfo            &wi      = cs.winfos[slot];
+    const TransedWordT<TChar> &pattern = cs.s.patterns[slot];
+    WorkGridT<TChar>          &grid    = cs.s.grid;
+    SearchFrame               &f       = cs.s.frames[slot];
+    cs.s.used[wi.len][f.word] = 0;
+    for (size_t j = 0; j < wi.len; ++j)
+        (wi.direct ? grid[wi.x + j][wi.y] : grid[wi.x][wi.y + j]) = pattern[j];
+    f.word = SearchFrame::NO_WORD;
+}
+
+// Shuffled candidates are permuted inside blocks of this number of positions,
+// so words of near scores stay near. It is power of 2
+static const size_t SHUFFLE_BLOCK = 32;
+
+// Position of candidate visited at position pos of frame with key order. Odd
+// multiplier and offset of block are taken from key and number of block, so
+// every block is permuted differently. The last incomplete block keeps order
+static inline size_t shufflePos(size_t pos, size_t count, uint32_t order){
+    const size_t block = pos & ~(SHUFFLE_BLOCK - 1);
+    if ( (order == 0) || (block + SHUFFLE_BLOCK > count) )
+        return pos;
+    const uint32_t key = order ^ (static_cast<uint32_t>(block) * 2654435761u);
+    const size_t   mul = (key >> 16) | 1;
+    return block | ((pos * mul + key) & (SHUFFLE_BLOCK - 1));
+}
+
+// Next candidate of frame which can be written to slot, NO_WORD if there are
+// no more ones. Position goes round without division, it is slower than
+// matching. Positions are copied to locals: marks of used words are bytes,
+// they can alias frame, so fields would be reloaded after every mark
+template <class TChar, size_t LEN>
+static WordIndex findNextWord(const CrossSearch<TChar> &cs, size_t slot, size_t len,
+    const SlotKernel<TChar, LEN> &kernel){
+    SearchFrame                              &f      = cs.s.frames[slot];
+    const std::vector< TransedWordT<TChar> > &bucket = cs.words[len];
+    const std::vector<WordIndex>             &cands  = cs.s.cands[slot];
+    const std::vector<uint8_t>               &used   = cs.s.used[len];
+    const bool     use_dawg   = f.use_dawg;
+    const bool     need_match = f.need_match;
+    const size_t   count      = f.count;
+    const uint32_t order      = f.order;
+    size_t pos    = f.pos;
+    size_t looked = f.looked;
+    WordIndex res = SearchFrame::NO_WORD;
+    for (; looked < count; ++looked) {
+        const size_t cur_pos = shufflePos(pos, count, order);
+        size_t cur_word_ind_len = use_dawg ? cands[cur_pos] : cur_pos;
+        if ( ++pos == count )
+            pos = 0;
+        if ( used[cur_word_ind_len] )
+            continue;
+        // Показывает, можно ли записать это слово в сетку
+        if ( need_match && !kernel.match(bucket[cur_word_ind_len].data()) )
+            continue;
+        ++looked;
+        res = static_cast<WordIndex>(cur_word_ind_len);
+        break;
+    }
+    f.pos    = static_cast<uint32_t>(pos);
+    f.looked = static_cast<uint32_t>(looked);
+    return res;
+}
+
+// Ranked candidates of lookahead with equal ranks are in random order of key
+// of frame. Multiplication by odd number is permutation, so keys don't repeat
+struct LookaheadLess {
+    uint32_t order;
+    
+    bool operator()(uint64_t a, uint64_t b) const {
+        if ( (a >> 32) != (b >> 32) )
+            return a < b;
+        return ((static_cast<uint32_t>(a) ^ order) * 2654435761u) <
+            ((static_cast<uint32_t>(b) ^ order) * 2654435761u);
+    }
+};
+
+// Step of slot on stack. New frame (enter) gets its candidates, otherwise
+// word of frame is removed. Then the next candidate is written to grid.
+// Returns false if there are no more candidates, slot is empty then. Length
+// of slot is LEN if it isn't 0, so it is known at compile time for common
+// lengths
+template <class TChar, size_t LEN>
+static bool stepSlot(const CrossSearch<TChar> &cs, const size_t slot, const size_t rand_add,
+    const uint32_t order, const bool enter){
+    const size_t cur_len = LEN != 0 ? LEN : cs.winfos[slot].len;
+    const std::vector< TransedWordT<TChar> > &bucket = cs.words[cur_len];
+    SearchFrame                              &f      = cs.s.frames[slot];
+    std::vector<uint64_t>                    &ranked = cs.s.ranked[slot];
+    
+    if ( !enter ) {
+        removeWord(cs, slot);
+    } else {
+        openSlot(cs, slot);
+        ranked.clear();
+        f.rand_add   = static_cast<uint32_t>(rand_add);
+        f.order      = order;
+        f.looked     = 0;
+        f.ranked_pos = 0;
+        if ( f.count == 0 )
+            return false;
+        // Candidates are visited in the same order as all words without
+        // automaton: starting from word rand_add and then cyclically
+        const std::vector<WordIndex> &cands = cs.s.cands[slot];
+        size_t pos = f.use_dawg ? std::lower_bound(cands.begin(), cands.end(),
+            rand_add % bucket.size()) - cands.begin() : rand_add;
+        f.pos = static_cast<uint32_t>(pos % f.count);
+    }
+    SlotKernel<TChar, LEN> kernel;
+    initSlotKernel(kernel, cs.s.patterns[slot].data(), cur_len);
+    
+    // Lookahead: the first candidates are tried from the one leaving the most
+    // options to crossing slots, ties are broken by scores. Candidates leaving
+    // no options are skipped
+    size_t lookahead = (cs.ctrl != nullptr) && (cs.cgrid != nullptr) && (cs.dawgs != nullptr) ?
+        cs.ctrl->lookahead : 0;
+    if ( enter && (lookahead > 0) && prepareLookahead(cs, slot, cs.s.patterns[slot]) ) {
+        WordIndex cur_word_ind_len;
+        while ( (ranked.size() < lookahead) &&
+                ((cur_word_ind_len = findNextWord(cs, slot, cur_len, kernel)) != SearchFrame::NO_WORD) ) {
+            uint32_t rank = getLookaheadRank(cs, slot, bucket[cur_word_ind_len].data());
+            if ( rank > 0 )
+                ranked.push_back((static_cast<uint64_t>(LOOKAHEAD_CAP - rank) << 32) | cur_word_ind_len);
+        }
+        if ( order == 0 ) {
+            std::sort(ranked.begin(), ranked.end());
+        } else {
+            LookaheadLess less = {order};
+            std::sort(ranked.begin(), ranked.end(), less);
+        }
+    }
+    
+    WordIndex next = f.ranked_pos < ranked.size() ? static_cast<WordIndex>(ranked[f.ranked_pos++]) :
+        findNextWord(cs, slot, cur_len, kernel);
+    if ( next == SearchFrame::NO_WORD )
+        return false;
+    placeWord(cs, slot, next);
+    return true;
+}
+
+// State of search before entering slot depth
+template <class TChar>
+static void makeCheckpoint(const CrossSearch<TChar> &cs, size_t depth, uint64_t nodes){
+    SearchCheckpoint &cp = cs.s.checkpoint;
+    cp.key        = cs.key;
+    cp.attempt    = cs.s.attempt;
+    cp.nodes      = nodes;
+    cp.node_limit = cs.ctrl->node_limit;
+    cp.rng        = cs.s.rng;
+    cp.frames.assign(cs.s.frames.begin(), cs.s.frames.begin() + depth);
+    cp.ranked.resize(depth);
+    for (size_t i = 0; i < depth; ++i)
+        cp.ranked[i].assign(cs.s.ranked[i].begin(), cs.s.ranked[i].end());
+}
+
+// Backtracking over slots in order of winfos with explicit stack, so depth of
+// search isn't limited by stack of thread. Word is written to grid and marked
+// as used in place, both are restored when branch fails, so search doesn't
+// allocate anything except growth of scratch buffers. Search goes on from
+// slot s.depth, slots from first to it must have words. Returns false if
+// there is no fill or search is stopped by ctrl, then s.depth is slot where
+// it stopped and slots below it keep their words
+template <class TChar>
+static bool searchSlots(const CrossSearch<TChar> &cs, const size_t first){
+    // Most slots are 3-9 letters long, they get kernels of their length.
+    // Kernels are called by pointers, so they aren't inlined to one huge frame
+    typedef bool (*SlotStep)(const CrossSearch<TChar>&, const size_t, const size_t, const uint32_t,
+        const bool);
+    static const SlotStep steps[] = {
+        stepSlot<TChar, 0>, stepSlot<TChar, 0>, stepSlot<TChar, 0>,
+        stepSlot<TChar, 3>, stepSlot<TChar, 4>, stepSlot<TChar, 5>,
+        stepSlot<TChar, 6>, stepSlot<TChar, 7>, stepSlot<TChar, 8>,
+        stepSlot<TChar, 9>
+    };
+    const size_t KERNELS = sizeof(steps) / sizeof(steps[0]);
+    
+    GenerateControl *ctrl  = cs.ctrl;
+    size_t           slot  = cs.s.depth;
+    bool             enter = true; // slot is entered first time, else its next word is tried
+    while ( true ) {
+        bool filled = false;
+        size_t cur_len = slot < cs.winfos.size() ? cs.winfos[slot].len : 0;
+        if ( enter ) {
+            if ( ctrl != nullptr ) {
+                if ( ctrl->cancel || ((ctrl->node_limit != 0) && (ctrl->nodes >= ctrl->node_limit)) ) {
+                    cs.s.depth = slot;
+                    return false;
+                }
+                if ( slot > ctrl->best_depth )
+                    ctrl->best_depth = slot;
+                if ( (++ctrl->nodes & GenerateControl::PROGRESS_MASK) == 0 ) {
+                    if ( ctrl->on_progress )
+                        ctrl->on_progress(*ctrl);
+                    // State before this node, resumed search counts it again
+                    if ( (cs.key != 0) && ctrl->on_checkpoint ) {
+                        makeCheckpoint(cs, slot, ctrl->nodes - 1);
+                        ctrl->on_checkpoint(cs.s.checkpoint);
+                    }
+                }
+            }
+            if ( slot == cs.winfos.size() ) {
+                cs.s.depth = slot;
+                return true;
+            }
+            size_t   rand_add = nextSearchRand(cs.s.rng) % (ctrl != nullptr ? ctrl->rand_window : 8);
+            uint32_t order    = (ctrl != nullptr) && ctrl->shuffle ? nextSearchRand(cs.s.rng) | 1 : 0;
+            if ( cur_len < cs.words.size() )
+                filled = steps[cur_len < KERNELS ? cur_len : 0](cs, slot, rand_add, order, true);
+        } else {
+            filled = steps[cur_len < KERNELS ? cur_len : 0](cs, slot, 0, 0, false);
+        }
+        if ( filled ) {
+            ++slot;
+            enter = true;
+            continue;
+        }
+        // Slot has no more words, so the previous one gets its next word
+        if ( slot == first ) {
+            cs.s.depth = first;
+            return false;
+        }
+        --slot;
+        enter = false;
+    }
+}
+
+// Removes words of slots from first to s.depth after stopped search
+template <class TChar>
+static void unwindSlots(const CrossSearch<TChar> &cs, const size_t first){
+    while ( cs.s.depth > first )
+        removeWord(cs, --cs.s.depth);
+}
+
+// Writes words of frames of checkpoint to prepared scratch, search goes on
+// from the next slot. Returns false if checkpoint doesn't fit words, slots
+// stay empty then
+template <class TChar>
+static bool restoreCheckpoint(const CrossSearch<TChar> &cs, const SearchCheckpoint &cp){
+    if ( (cp.frames.size() > cs.winfos.size()) || (cp.ranked.size() != cp.frames.size()) )
+        return false;
+    for (size_t slot = 0; slot < cp.frames.size(); ++slot) {
+        const SearchFrame           &saved  = cp.frames[slot];
+        const std::vector<uint64_t> &ranked = cp.ranked[slot];
+        const size_t                 len    = cs.winfos[slot].len;
+        bool fits = (len < cs.words.size()) && (saved.word < cs.words[len].size());
+        if ( fits ) {
+            openSlot(cs, slot);
+            const TransedWordT<TChar> &pattern = cs.s.patterns[slot];
+            const TransedWordT<TChar> &word    = cs.words[len][saved.word];
+            const SearchFrame         &f       = cs.s.frames[slot];
+            fits = !cs.s.used[len][saved.word] && (saved.pos < f.count) &&
+                (saved.looked <= f.count) && (saved.ranked_pos <= ranked.size());
+            for (size_t j = 0; (j < len) && fits; ++j)
+                fits = (pattern[j] == TRANS_CLEAR) || (pattern[j] == word[j]);
+            for (size_t i = 0; (i < ranked.size()) && fits; ++i)
+                fits = static_cast<WordIndex>(ranked[i]) < cs.words[len].size();
+        }
+        if ( !fits ) {
+            unwindSlots(cs, 0);
+            return false;
+        }
+        SearchFrame &f = cs.s.frames[slot];
+        f.rand_add   = saved.rand_add;
+        f.order      = saved.order;
+        f.pos        = saved.pos;
+        f.looked     = saved.looked;
+        f.ranked_pos = saved.ranked_pos;
+        cs.s.ranked[slot].assign(ranked.begin(), ranked.end());
+        placeWord(cs, slot, saved.word);
+        cs.s.depth = slot + 1;
+    }
+    return true;
+}
+
+template <class TChar>
 bool procCross(
         UsedWords used,
-        const AllWordsType &words,
-        WorkGridType grid, 
+        const WordsStorageT<TChar> &words,
+        WorkGridT<TChar> grid, 
         const std::vector<WordInfo> &winfos,
         const size_t cur_word_ind,
-        std::vector<TransedWord> &out
+        std::vector<WordUniq> &out,
+        GenerateControl *ctrl,
+        const WordsDawgsT<TChar> *dawgs
 ){
-    if ( cur_word_ind == winfos.size() )
+    SearchScratch<TChar> scratch;
+    scratch.prepare(words, winfos.size());
+    scratch.grid.swap(grid);
+    for (auto id: used)
+        if ( (getUniqLen(id) < words.size()) && (getUniqInd(id) < words[getUniqLen(id)].size()) )
+            scratch.used[getUniqLen(id)][getUniqInd(id)] = 1;
+    scratch.depth = cur_word_ind;
+    scratch.rng   = static_cast<uint64_t>(rand());
+    CrossSearch<TChar> cs = {words, dawgs, winfos, scratch, ctrl, nullptr, 0};
+    if ( !searchSlots(cs, cur_word_ind) )
+        return false;
+    for (size_t i = winfos.size(); i-- > cur_word_ind; )
+        out.push_back(scratch.path[i]);
+    return true;
+}
+
+// Nodes of the shortest attempt of backtracking
+static const uint64_t RESTART_NODES       = 1 << 12;
+// Candidates of slot after restart start from random one of this number of
+// best ones, and they are shuffled by blocks (shufflePos)
+static const size_t   RESTART_RAND_WINDOW = 32;
+
+// i-th (from 1) element of Luby sequence: 1 1 2 1 1 2 4 1 1 2 1 1 2 4 8 ...
+static uint64_t lubySequence(uint64_t i){
+    uint64_t k = 1;
+    while ( ((uint64_t(1) << k) - 1) < i )
+        ++k;
+    if ( i == (uint64_t(1) << k) - 1 )
+        return uint64_t(1) << (k - 1);
+    return lubySequence(i - (uint64_t(1) << (k - 1)) + 1);
+}
+
+template <class TChar>
+static uint64_t getSearchKeyT(const CompiledGrid &cgrid, const WordsStorageT<TChar> &words,
+    const WordsDawgsT<TChar> &dawgs, size_t lookahead){
+    uint64_t key = cgrid.hash;
+    auto mix = [&key](uint64_t v) {
+        key = (key ^ v) * 1099511628211ULL;
+    };
+    for (auto &wi: cgrid.winfos) {
+        mix(wi.len < words.size() ? words[wi.len].size() : 0);
+        mix((wi.len < dawgs.size()) && !dawgs[wi.len].empty() ? 1 : 0);
+    }
+    mix(lookahead);
+    return key != 0 ? key : 1;
+}
+
+uint64_t getSearchKey(const CompiledGrid &cgrid, const AllWordsType &words, size_t lookahead){
+    if ( words.wide )
+        return getSearchKeyT(cgrid, words.wide_words, words.wide_dawgs, lookahead);
+    return getSearchKeyT(cgrid, words.narrow_words, words.narrow_dawgs, lookahead);
+}
+
+static const char   CHECKPOINT_MAGIC[]   = "CROSSCK2";
+static const size_t CHECKPOINT_MAGIC_LEN = 8;
+// key, attempt, nodes, node_limit and rng
+static const size_t CHECKPOINT_NUMBERS   = 5;
+// rand_add, order, pos, looked, ranked_pos and word
+static const size_t CHECKPOINT_FRAME_LEN = 6 * 4;
+
+bool writeSearchCheckpoint(const std::string &path, const SearchCheckpoint &cp){
+    std::string data(CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_LEN);
+    const uint64_t numbers[CHECKPOINT_NUMBERS] = {cp.key, cp.attempt, cp.nodes, cp.node_limit, cp.rng};
+    for (auto v: numbers)
+        putLE(data, v, 8);
+    putLE(data, cp.frames.size(), 4);
+    for (auto &f: cp.frames) {
+        putLE(data, f.rand_add, 4);
+        putLE(data, f.order, 4);
+        putLE(data, f.pos, 4);
+        putLE(data, f.looked, 4);
+        putLE(data, f.ranked_pos, 4);
+        putLE(data, f.word, 4);
+    }
+    for (auto &ranked: cp.ranked) {
+        putLE(data, ranked.size(), 4);
+        for (auto v: ranked)
+            putLE(data, v, 8);
+    }
+    const std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream f(tmp_path, std::ios::binary);
+        f.write(data.data(), data.size());
+        if ( !f )
+            return false;
+    }
+    if ( std::rename(tmp_path.c_str(), path.c_str()) == 0 )
         return true;
-    WordInfo cur_wi = winfos.at(cur_word_ind);
-    size_t rand_add = rand() % 8;
-    size_t cur_len  = cur_wi.len;
-    size_t cur_words_size = words[cur_len].size();
-    for (size_t icw = 0; icw < cur_words_size; ++icw){
-        if ( used.find(getWordUniq(icw,cur_len)) != used.end() )
+    // Windows doesn't rename to existing file
+    std::remove(path.c_str());
+    return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+bool readSearchCheckpoint(const std::string &path, SearchCheckpoint &cp_out){
+    std::ifstream f(path, std::ios::binary);
+    if ( !f )
+        return false;
+    std::string data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    size_t pos = CHECKPOINT_MAGIC_LEN + CHECKPOINT_NUMBERS * 8 + 4;
+    if ( (data.size() < pos) || (data.compare(0, CHECKPOINT_MAGIC_LEN, CHECKPOINT_MAGIC) != 0) )
+        return false;
+    uint64_t *numbers[CHECKPOINT_NUMBERS] = {&cp_out.key, &cp_out.attempt, &cp_out.nodes,
+        &cp_out.node_limit, &cp_out.rng};
+    for (size_t i = 0; i < CHECKPOINT_NUMBERS; ++i)
+        *numbers[i] = getLE(data, CHECKPOINT_MAGIC_LEN + i * 8, 8);
+    size_t count = static_cast<size_t>(getLE(data, pos - 4, 4));
+    if ( (data.size() - pos) / CHECKPOINT_FRAME_LEN < count )
+        return false;
+    cp_out.frames.resize(count);
+    for (auto &fr: cp_out.frames) {
+        fr.rand_add   = static_cast<uint32_t>(getLE(data, pos, 4));
+        fr.order      = static_cast<uint32_t>(getLE(data, pos + 4, 4));
+        fr.pos        = static_cast<uint32_t>(getLE(data, pos + 8, 4));
+        fr.looked     = static_cast<uint32_t>(getLE(data, pos + 12, 4));
+        fr.ranked_pos = static_cast<uint32_t>(getLE(data, pos + 16, 4));
+        fr.word       = static_cast<WordIndex>(getLE(data, pos + 20, 4));
+        pos += CHECKPOINT_FRAME_LEN;
+    }
+    cp_out.ranked.resize(count);
+    for (auto &ranked: cp_out.ranked) {
+        if ( pos + 4 > data.size() )
+            return false;
+        size_t size = static_cast<size_t>(getLE(data, pos, 4));
+        pos += 4;
+        if ( (data.size() - pos) / 8 < size )
+            return false;
+        ranked.resize(size);
+        for (auto &v: ranked) {
+            v = getLE(data, pos, 8);
+            pos += 8;
+        }
+    }
+    return pos == data.size();
+}
+
+template <class TChar>
+static void generateCrossT(const CompiledGrid &cgrid, const WordsStorageT<TChar> &words,
+    const WordsDawgsT<TChar> &dawgs, SearchScratch<TChar> &scratch,
+    std::vector<WordUniq> &ids_out, GenerateControl *ctrl){
+    TraceScope trace("generateCross");
+    
+    const std::vector<WordInfo> &winfos = cgrid.winfos;
+    #ifndef NDEBUG
+        for (auto el: winfos)
+            crossLogDebug("Word at (%2zu,%2zu) with len = %2zu and index = %2zu and dir = %d",
+              el.x,el.y,el.len, el.ind, int(el.direct));
+    #endif
+    
+    GenerateControl own_ctrl;
+    if ( ctrl == nullptr )
+        ctrl = &own_ctrl;
+    const SearchCheckpoint *resume = ctrl->resume;
+    ctrl->resume = nullptr;
+    CrossSearch<TChar> cs = {words, dawgs.empty() ? nullptr : &dawgs, winfos, scratch, ctrl, &cgrid,
+        getSearchKeyT(cgrid, words, dawgs, ctrl->lookahead)};
+    ids_out.clear();
+    // Failed attempt restores every cell, so work grid is made once
+    toWorkGridType(cgrid.grid, scratch.grid);
+    uint64_t attempt = 1;
+    bool     resumed = false;
+    if ( (resume != nullptr) && (resume->key == cs.key) ) {
+        scratch.prepare(words, winfos.size());
+        resumed = restoreCheckpoint(cs, *resume);
+        if ( resumed ) {
+            attempt     = resume->attempt;
+            ctrl->nodes = resume->nodes;
+        }
+        crossLogDebug("Checkpoint with %zu slots is %s", resume->frames.size(),
+            resumed ? "restored" : "broken");
+    }
+    scratch.rng = resumed ? resume->rng : static_cast<uint64_t>(rand());
+    // Time of search is heavy-tailed, so attempt is stopped after some nodes
+    // and search starts again with other random order of candidates. Limit
+    // grows, so search is still complete: attempt which ends before limit
+    // proves that there is no crossword
+    for (; ; ++attempt) {
+        if ( resumed ) {
+            ctrl->node_limit = resume->node_limit;
+        } else {
+            scratch.prepare(words, winfos.size());
+            ctrl->node_limit = ctrl->nodes + RESTART_NODES * lubySequence(attempt);
+        }
+        resumed           = false;
+        scratch.attempt   = attempt;
+        ctrl->rand_window = attempt == 1 ? 8 : RESTART_RAND_WINDOW;
+        ctrl->shuffle     = attempt > 1;
+        if ( searchSlots(cs, 0) ) {
+            ids_out.assign(scratch.path.begin(), scratch.path.begin() + winfos.size());
+            break;
+        }
+        // Cancelled search can be resumed from the last node
+        if ( ctrl->cancel && ctrl->on_checkpoint ) {
+            makeCheckpoint(cs, scratch.depth, ctrl->nodes);
+            ctrl->on_checkpoint(scratch.checkpoint);
+        }
+        unwindSlots(cs, 0);
+        if ( ctrl->cancel || (ctrl->nodes < ctrl->node_limit) )
+            break;
+        crossLogDebug("Restart #%u after %u nodes", unsigned(attempt), unsigned(ctrl->nodes));
+    }
+    ctrl->node_limit  = 0;
+    ctrl->rand_window = 8;
+    ctrl->shuffle     = false;
+}
+
+void generateCrossIds(const CompiledGrid &cgrid, const AllWordsType &words,
+    std::vector<WordUniq> &ids_out, GenerateControl *ctrl){
+    if ( words.wide ) {
+        SearchScratch<WideTransedChar> scratch;
+        generateCrossT(cgrid, words.wide_words, words.wide_dawgs, scratch, ids_out, ctrl);
+    } else {
+        SearchScratch<TransedChar> scratch;
+        generateCrossT(cgrid, words.narrow_words, words.narrow_dawgs, scratch, ids_out, ctrl);
+    }
+}
+
+void generateCrossIds(const GridType &grid, const AllWordsType &words,
+    std::vector<WordUniq> &ids_out, GenerateControl *ctrl){
+    CompiledGrid cgrid;
+    compileGrid(grid, cgrid);
+    generateCrossIds(cgrid, words, ids_out, ctrl);
+}
+
+bool parseSolverEngine(const std::string &name, SolverEngine &engine_out){
+    if ( name == "backtracking" )
+        engine_out = SolverEngine::Backtracking;
+    else if ( name == "local" )
+        engine_out = SolverEngine::LocalSearch;
+    else
+        return false;
+    return true;
+}
+
+void generateCrossIds(const CompiledGrid &cgrid, const AllWordsType &words, SolverEngine engine,
+    std::vector<WordUniq> &ids_out, GenerateControl *ctrl){
+    if ( engine == SolverEngine::LocalSearch )
+        generateCrossIdsLocal(cgrid, words, ids_out, ctrl);
+    else
+        generateCrossIds(cgrid, words, ids_out, ctrl);
+}
+
+// State of anytime search besides scratch. Slots are filled like in
+// searchSlots: frames of scratch are explicit stack, words are written to
+// grid of scratch and marked as used in place, so nodes don't allocate
+struct BestCrossSearch {
+    const std::vector< SharedVector<int> > &scores;
+    std::vector< long long >              rest_bound; // max score of slots [i, end)
+    std::vector< WordUniq >               best;
+    long long                             best_score;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point deadline;
+    std::vector< BestCrossPoint >         *curve;
+    GenerateControl                       *ctrl;
+    uint64_t                              nodes;
+    bool                                  stopped;
+    
+    explicit BestCrossSearch(const std::vector< SharedVector<int> > &scores_):
+        scores(scores_), best_score(-1), curve(nullptr), ctrl(nullptr), nodes(0), stopped(false) {}
+};
+
+// Step of slot of anytime search: new frame (enter) gets its candidates,
+// otherwise word of frame is removed. Then the next candidate which can beat
+// the best fill is written to grid. cur_score is sum of scores of slots
+// before this one and its word. Returns false if there are no more candidates
+template <class TChar>
+static bool stepBestSlot(const CrossSearch<TChar> &cs, BestCrossSearch &s, size_t slot,
+    long long &cur_score, bool enter){
+    const size_t                len           = cs.winfos[slot].len;
+    const std::vector<int>     &bucket_scores = s.scores[len];
+    const std::vector<uint8_t> &used          = cs.s.used[len];
+    const std::vector<WordIndex> &cands       = cs.s.cands[slot];
+    const TransedWordT<TChar>  &pattern       = cs.s.patterns[slot];
+    SearchFrame                &f             = cs.s.frames[slot];
+    if ( !enter ) {
+        cur_score -= bucket_scores[f.word];
+        removeWord(cs, slot);
+    } else {
+        openSlot(cs, slot);
+        f.pos = 0;
+    }
+    for (; f.pos < f.count; ++f.pos) {
+        WordIndex ind = f.use_dawg ? cands[f.pos] : f.pos;
+        // Words are sorted from best to worst, so next ones can't beat best fill too
+        if ( cur_score + bucket_scores[ind] + s.rest_bound[slot + 1] <= s.best_score )
+            break;
+        if ( used[ind] )
             continue;
-        TransedWord cur_word = words[cur_len][(icw + rand_add) % cur_words_size];
-        // Показывает, можно ли записать это слово в сетку
+        const TransedWordT<TChar> &cur_word = cs.words[len][ind];
         bool can_write = true;
-        if ( cur_wi.direct ){
-            for (size_t j = 0; j < cur_wi.len; ++j)
-                if ( (grid[cur_wi.x + j][cur_wi.y] != TRANS_CLEAR) &&
-                   (grid[cur_wi.x + j][cur_wi.y] != cur_word[j]) )
-                    can_write = false;
+        for (size_t j = 0; (j < len) && can_write && f.need_match; ++j)
+            can_write = (pattern[j] == TRANS_CLEAR) || (pattern[j] == cur_word[j]);
+        if ( !can_write )
+            continue;
+        ++f.pos;
+        placeWord(cs, slot, ind);
+        cur_score += bucket_scores[ind];
+        return true;
+    }
+    return false;
+}
+
+// Branch and bound over slots in order of winfos with explicit stack. Every
+// complete fill is better than the previous one, it becomes the best
+template <class TChar>
+static void searchBestSlots(const CrossSearch<TChar> &cs, BestCrossSearch &s){
+    // Clock is read rarely, it is slower than search node
+    const uint64_t DEADLINE_MASK = (1 << 8) - 1;
+    size_t    slot      = 0;
+    long long cur_score = 0;
+    bool      enter     = true;
+    while ( true ) {
+        bool filled = false;
+        if ( enter ) {
+            if ( ((++s.nodes & DEADLINE_MASK) == 0) && (std::chrono::steady_clock::now() >= s.deadline) )
+                s.stopped = true;
+            if ( s.ctrl != nullptr ) {
+                if ( s.ctrl->cancel )
+                    s.stopped = true;
+                if ( slot > s.ctrl->best_depth )
+                    s.ctrl->best_depth = slot;
+                if ( ((++s.ctrl->nodes & GenerateControl::PROGRESS_MASK) == 0) && s.ctrl->on_progress )
+                    s.ctrl->on_progress(*s.ctrl);
+            }
+            if ( s.stopped )
+                break;
+            if ( slot == cs.winfos.size() ) {
+                s.best.assign(cs.s.path.begin(), cs.s.path.begin() + slot);
+                s.best_score = cur_score;
+                if ( s.curve != nullptr ) {
+                    BestCrossPoint point;
+                    point.time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - s.start).count();
+                    point.score   = cur_score;
+                    point.nodes   = s.nodes;
+                    s.curve->push_back(point);
+                }
+            } else if ( cs.winfos[slot].len < cs.words.size() ) {
+                filled = stepBestSlot(cs, s, slot, cur_score, true);
+            }
         } else {
-            for (size_t j = 0; j < cur_wi.len; ++j)
-                if ( (grid[cur_wi.x][j + cur_wi.y] != TRANS_CLEAR) &&
-                    (grid[cur_wi.x][j + cur_wi.y] != cur_word[j]) )
-                    can_write = false;
+            filled = stepBestSlot(cs, s, slot, cur_score, false);
+        }
+        if ( filled ) {
+            ++slot;
+            enter = true;
+            continue;
+        }
+        if ( slot == 0 )
+            break;
+        --slot;
+        enter = false;
+    }
+    cs.s.depth = slot;
+    unwindSlots(cs, 0);
+}
+
+template <class TChar>
+static bool generateBestCrossT(const CompiledGrid &cgrid, const WordsStorageT<TChar> &words,
+    const std::vector< SharedVector<int> > &scores, const WordsDawgsT<TChar> &dawgs,
+    SearchScratch<TChar> &scratch, long long budget_ms, std::vector<WordUniq> &ids_out,
+    std::vector<BestCrossPoint> *curve, GenerateControl *ctrl){
+    TraceScope trace("generateBestCross");
+    
+    const std::vector<WordInfo> &winfos = cgrid.winfos;
+    BestCrossSearch s(scores);
+    // Optimistic bound: every slot gets the best word of its length
+    s.rest_bound.assign(winfos.size() + 1, 0);
+    for (size_t i = winfos.size(); i-- > 0; ) {
+        size_t len = winfos[i].len;
+        bool has_words = (len < scores.size()) && !scores[len].empty();
+        s.rest_bound[i] = s.rest_bound[i + 1] + (has_words ? scores[len].front() : 0);
+    }
+    toWorkGridType(cgrid.grid, scratch.grid);
+    scratch.prepare(words, winfos.size());
+    CrossSearch<TChar> cs = {words, dawgs.empty() ? nullptr : &dawgs, winfos, scratch, nullptr,
+        &cgrid, 0};
+    s.start    = std::chrono::steady_clock::now();
+    s.deadline = s.start + std::chrono::milliseconds(budget_ms);
+    s.curve    = curve;
+    s.ctrl     = ctrl;
+    searchBestSlots(cs, s);
+    ids_out.swap(s.best);
+    return !s.stopped;
+}
+
+bool generateBestCrossIds(const CompiledGrid &cgrid, const AllWordsType &words, long long budget_ms,
+    std::vector<WordUniq> &ids_out, std::vector<BestCrossPoint> *curve, GenerateControl *ctrl){
+    ids_out.clear();
+    if ( words.wide ) {
+        SearchScratch<WideTransedChar> scratch;
+        return generateBestCrossT(cgrid, words.wide_words, words.scores, words.wide_dawgs, scratch,
+            budget_ms, ids_out, curve, ctrl);
+    }
+    SearchScratch<TransedChar> scratch;
+    return generateBestCrossT(cgrid, words.narrow_words, words.scores, words.narrow_dawgs, scratch,
+        budget_ms, ids_out, curve, ctrl);
+}
+
+long long getCrossScore(const AllWordsType &words, const std::vector<WordUniq> &ids){
+    long long res = 0;
+    for (auto id: ids)
+        res += words.scores.at(getUniqLen(id)).at(getUniqInd(id));
+    return res;
+}
+
+template <class TChar>
+static void regenerateCrossT(const CompiledGrid &cgrid, const WordsStorageT<TChar> &words,
+    const WordsDawgsT<TChar> &dawgs, const std::vector<WordUniq> &ids,
+    const std::vector<size_t> &unlock, std::vector<WordUniq> &ids_out, GenerateControl *ctrl){
+    TraceScope trace("regenerateCross");
+    
+    ids_out.clear();
+    const std::vector<WordInfo> &winfos = cgrid.winfos;
+    if ( ids.size() != winfos.size() )
+        return;
+    
+    std::vector<bool>   in_region(winfos.size(), false);
+    std::vector<size_t> frontier;
+    UsedWords           rejected; // previous answers of unlocked slots aren't used again
+    for (auto i: unlock)
+        if ( (i < winfos.size()) && !in_region[i] ) {
+            in_region[i] = true;
+            frontier.push_back(i);
+            rejected.insert(ids[i]);
         }
+    if ( frontier.empty() ) {
+        ids_out = ids;
+        return;
+    }
+    
+    while ( true ) {
+        // Region grows by slots crossing it
+        std::vector<size_t> next;
+        for (auto i: frontier)
+            for (size_t j = 0; j < winfos[i].len; ++j) {
+                const SlotPos &cross = cgrid.crossOf(i, j);
+                if ( (cross.slot != CompiledGrid::NO_SLOT) && !in_region[cross.slot] ) {
+                    in_region[cross.slot] = true;
+                    next.push_back(cross.slot);
+                }
+            }
+        frontier.swap(next);
         
-        if ( can_write ) {
-            UsedWords t_used(used);
-            t_used.insert(getWordUniq(icw,cur_len));
-            
-            WorkGridType t_grid(grid);
-            
-            if ( cur_wi.direct ){
-                for (size_t j = 0; j < cur_wi.len; ++j)
-                    t_grid[cur_wi.x + j][cur_wi.y] = cur_word[j];
-            } else {
-                for (size_t j = 0; j < cur_wi.len; ++j)
-                    t_grid[cur_wi.x][j + cur_wi.y] = cur_word[j];
+        // Answers outside of region are written to grid and can't be used twice
+        WorkGridT<TChar> grid_work;
+        toWorkGridType(cgrid.grid, grid_work);
+        UsedWords             used(rejected);
+        std::vector<WordInfo> region;
+        std::vector<size_t>   region_inds;
+        for (size_t i = 0; i < winfos.size(); ++i) {
+            const WordInfo &wi = winfos[i];
+            if ( in_region[i] ) {
+                region.push_back(wi);
+                region_inds.push_back(i);
+                continue;
             }
-                
-            if ( procCross(t_used, words, t_grid, winfos, cur_word_ind + 1, out) ){
-                out.push_back(cur_word);
-                return true;
+            used.insert(ids[i]);
+            const TransedWordT<TChar> &tw = words.at(getUniqLen(ids[i])).at(getUniqInd(ids[i]));
+            for (size_t j = 0; j < wi.len; ++j) {
+                if ( wi.direct )
+                    grid_work[wi.x + j][wi.y] = tw.at(j);
+                else
+                    grid_work[wi.x][wi.y + j] = tw.at(j);
             }
         }
+        crossLogDebug("Regenerating %zu of %zu slots", region.size(), winfos.size());
+        
+        std::vector<WordUniq> region_out;
+        if ( procCross(used, words, grid_work, region, 0, region_out, ctrl,
+                dawgs.empty() ? nullptr : &dawgs) ) {
+            std::reverse(region_out.begin(), region_out.end());
+            ids_out = ids;
+            for (size_t k = 0; k < region_inds.size(); ++k)
+                ids_out[region_inds[k]] = region_out.at(k);
+            return;
+        }
+        if ( ((ctrl != nullptr) && ctrl->cancel) || frontier.empty() )
+            return;
     }
-    return false;
+}
+
+void regenerateCrossIds(const CompiledGrid &cgrid, const AllWordsType &words,
+    const std::vector<WordUniq> &ids, const std::vector<size_t> &unlock,
+    std::vector<WordUniq> &ids_out, GenerateControl *ctrl){
+    if ( words.wide )
+        regenerateCrossT(cgrid, words.wide_words, words.wide_dawgs, ids, unlock, ids_out, ctrl);
+    else
+        regenerateCrossT(cgrid, words.narrow_words, words.narrow_dawgs, ids, unlock, ids_out, ctrl);
+}
+
+template <class TChar>
+static void getWordsByIdsT(const WordsStorageT<TChar> &words, const std::vector<char32_t> &back,
+    const std::vector<WordUniq> &ids, std::vector<std::u32string> &words_out){
+    words_out.resize(ids.size());
+    for (size_t i = 0; i < ids.size(); ++i) {
+        const TransedWordT<TChar> &tw = words.at(getUniqLen(ids[i])).at(getUniqInd(ids[i]));
+        // Size is set without new string, so buffer of previous word is reused
+        words_out[i].resize(tw.size());
+        for (size_t j = 0; j < tw.size(); ++j)
+            words_out[i][j] = back[tw[j]];
+    }
+}
+
+void getWordsByIds(const AllWordsType &words, const CharsTransType &trans_type,
+    const std::vector<WordUniq> &ids, std::vector<std::u32string> &words_out){
+    if ( words.wide )
+        getWordsByIdsT(words.wide_words, trans_type.letters(), ids, words_out);
+    else
+        getWordsByIdsT(words.narrow_words, trans_type.letters(), ids, words_out);
+}
+
+GenerateContext::GenerateContext(const AllWordsType &words, const CharsTransType &trans):
+        _words(words), _trans(trans){
+}
+
+void GenerateContext::generate(const CompiledGrid &cgrid, std::vector<WordUniq> &ids_out,
+        GenerateControl *ctrl){
+    if ( _words.wide )
+        generateCrossT(cgrid, _words.wide_words, _words.wide_dawgs, _wide, ids_out, ctrl);
+    else
+        generateCrossT(cgrid, _words.narrow_words, _words.narrow_dawgs, _narrow, ids_out, ctrl);
+}
+
+bool GenerateContext::generateBest(const CompiledGrid &cgrid, long long budget_ms,
+        std::vector<WordUniq> &ids_out, std::vector<BestCrossPoint> *curve, GenerateControl *ctrl){
+    ids_out.clear();
+    if ( _words.wide )
+        return generateBestCrossT(cgrid, _words.wide_words, _words.scores, _words.wide_dawgs, _wide,
+            budget_ms, ids_out, curve, ctrl);
+    return generateBestCrossT(cgrid, _words.narrow_words, _words.scores, _words.narrow_dawgs, _narrow,
+        budget_ms, ids_out, curve, ctrl);
+}
+
+void GenerateContext::getWords(const std::vector<WordUniq> &ids,
+        std::vector<std::u32string> &words_out) const{
+    if ( _words.wide )
+        getWordsByIdsT(_words.wide_words, _trans.letters(), ids, words_out);
+    else
+        getWordsByIdsT(_words.narrow_words, _trans.letters(), ids, words_out);
+}
+
+size_t GenerateContext::memoryUsage() const{
+    return _narrow.memoryUsage() + _wide.memoryUsage();
 }
 
 void generateCross(const GridType &grid, const AllWordsType &words, 
-    const CharsTransType &trans_type, std::vector<wxString> &words_out){
-    
-    std::vector<WordInfo> winfos;
-    generateWordInfo(grid, winfos);
-    for (auto el: winfos)
-        wxLogDebug(wxT("Word at (%2d,%2d) with len = %2d and index = %2d and dir = %d"),
-          el.x,el.y,el.len, el.ind, int(el.direct));
-          
-    WorkGridType grid_work;
-    toWorkGridType(grid, grid_work);
-    UsedWords t_used;
-    std::vector< TransedWord > words_trans_out;
-    procCross(t_used, words, grid_work, winfos, 0, words_trans_out);
-    std::reverse(words_trans_out.begin(), words_trans_out.end());
-    BackedCharsTransType bctt = getFromCharsTransed(trans_type);
-    words_out.resize(words_trans_out.size());
-    std::transform(
-        words_trans_out.begin(),
-        words_trans_out.end(),
-        words_out.begin(), [bctt](const TransedWord &tw){
-            return getFromTransed(tw, bctt);
-        }
-    );
+    const CharsTransType &trans_type, std::vector<std::u32string> &words_out,
+    GenerateControl *ctrl){
+    std::vector<WordUniq> ids;
+    generateCrossIds(grid, words, ids, ctrl);
+    getWordsByIds(words, trans_type, ids, words_out);
 }
+
+template void toWorkGridType(const GridType&, WorkGridT<TransedChar>&);
+template void toWorkGridType(const GridType&, WorkGridT<WideTransedChar>&);
+
+template bool procCross(UsedWords, const WordsStorageT<TransedChar>&, 
+    WorkGridT<TransedChar>, const std::vector<WordInfo>&, const size_t,
+    std::vector<WordUniq>&, GenerateControl*,
+    const WordsDawgsT<TransedChar>*);
+template bool procCross(UsedWords, const WordsStorageT<WideTransedChar>&, 
+    WorkGridT<WideTransedChar>, const std::vector<WordInfo>&, const size_t,
+    std::vector<WordUniq>&, GenerateControl*,
+    const WordsDawgsT<WideTransedChar>*);
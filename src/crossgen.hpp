@@ -2,54 +2,343 @@
 #define CROSSGEN_HPP
 
 #include <cmath>
+#include <cstdlib>
 #include <set>
 #include <vector>
 #include <map>
 #include <algorithm>
+#include <atomic>
 #include <functional>
+#include <stdexcept>
 
-#include <wx/wx.h>
-#include <wx/textfile.h>
+#include <string>
 
 #include "crossbasetypes.hpp"
+#include "crossgrid.hpp"
+#include "crossutils.hpp"
 
-extern const wxChar      CELL_CLEAR     ;
-extern const wxChar      CELL_BORDER    ;
-extern const TransedChar TRANS_CLEAR    ;
-extern const TransedChar TRANS_BORDER   ;
-extern const uint32_t    MAX_WORD_COUNT ;
+extern const char32_t    CELL_CLEAR         ;
+extern const char32_t    CELL_BORDER        ;
+extern const TransedChar TRANS_CLEAR        ;
+extern const TransedChar TRANS_BORDER       ;
+extern const size_t      MAX_NARROW_LETTERS ;
+extern const size_t      MAX_WIDE_LETTERS   ;
 
-void readDict(const wxString &path, DictType &dict_out);
+// Returns false if file cannot be opened. Paths are in UTF-8
+bool readDict(const std::string &path, DictType &dict_out);
 
-void readGrid(const wxString &path, GridType &grid);
+bool readGrid(const std::string &path, GridType &grid);
 
-wxString getFromTransed(const TransedWord &tw, const BackedCharsTransType &bchar_trans);
+template <class TChar>
+std::u32string getFromTransed(const TransedWordT<TChar> &tw, const CharsTransType &char_trans){
+    std::u32string s;
+    s.resize(tw.size());
+    for (size_t i = 0; i < tw.size(); ++i){
+        s[i] = char_trans.letter(tw[i]);
+    }
+    return s;
+}
 
-BackedCharsTransType getFromCharsTransed(const CharsTransType &char_trans);
+template <class TChar>
+void toWorkGridType(const GridType &grid, WorkGridT<TChar> &grid_out);
 
-void toWorkGridType(const GridType &grid, WorkGridType &grid_out);
+// Scores words by frequencies of their letters in dictionary
+struct WordScorer {
+    std::map<char32_t, size_t> freqs;
+    size_t                     char_cnt;
+    
+    WordScorer(): char_cnt(0) {}
+    
+    // Returns -1 if this word is so bad to include to dict else returns
+    // points for scoring. More = better
+    int operator()(const std::u32string &s) const;
+};
 
+// Every word of dictionary gets one id however many clues it has, its clues
+// are put to clues_out
 void generateAllWords(const DictType &dict, AllWordsType &words_out, 
-        CharsTransType &char_trans_out);
+        CharsTransType &char_trans_out, ClueIndex &clues_out, WordScorer &scorer_out);
+
+// Words of lengths which aren't prepared yet, it is opaque
+struct DictSource;
+
+// Dictionary with everything needed for generation. It isn't changed after
+// loading, so one instance can be shared between threads. New version is
+// made by applyDictDelta and replaces old one by swapping of pointers.
+// Lazily loaded dictionary has only codes of letters and frequencies, buckets
+// of words, their scores, clues and automatons are filled by
+// prepareDictLengths on first use of length, so they are mutable
+struct PreparedDict {
+    mutable AllWordsType        words;
+    CharsTransType              trans;
+    mutable ClueIndex           clues;
+    WordScorer                  scorer; // letter frequencies of full loading, deltas don't change them
+    std::shared_ptr<DictSource> source; // nullptr if dictionary isn't lazy
+};
+
+// readDict + generateAllWords. With lazy only letters are counted, lengths are
+// prepared by prepareDictLengths. Returns false if file cannot be opened
+bool loadDict(const std::string &path, PreparedDict &dict_out, bool lazy = false);
+
+// Prepares lengths of slots of cgrid, words of other lengths stay raw. Length
+// is prepared once, then it is only read, so it can be called from many
+// threads and while other threads generate. Lengths of grid must be prepared
+// before generation, unprepared ones have no words
+void prepareDictLengths(const PreparedDict &dict, const CompiledGrid &cgrid);
+// Prepares all lengths
+void prepareDictLengths(const PreparedDict &dict);
+
+// Makes new version of base with changes from delta file in UTF-8, base isn't
+// changed. Lines of delta:
+//     +WORD - clue   adds clue, word is added if it is new
+//     -WORD - clue   removes clue, word is removed with its last clue
+//     -WORD          removes word with all its clues
+//     =WORD - clue   replaces all clues of word, next = lines of word add clues
+// Only changed length buckets are updated: old words aren't scored and sorted
+// again, new words are put by their scores. Added words are used even if
+// scorer thinks they are bad. All lengths of lazy base are prepared first, so
+// new version isn't lazy. Returns false if file cannot be opened
+bool applyDictDelta(const PreparedDict &base, const std::string &path, PreparedDict &dict_out);
+
+// Builds automatons of all length buckets. It is optional: solver tests only
+// words matching letters of slot, but automatons are kept besides words, so
+// dictionary takes more memory.
+// Lengths of lazy dictionary prepared later get automatons too
+void buildWordsDawgs(AllWordsType &words);
 
 void generateWordInfo(const GridType &grid, std::vector<WordInfo> &winfos_out);
 
 template <class T>
-uint32_t getWordUniq(const T &w_ind, const T &w_len){
-    return w_ind + w_len * MAX_WORD_COUNT;
+WordUniq getWordUniq(const T &w_ind, const T &w_len){
+    return (static_cast<WordUniq>(w_len) << 32) | static_cast<WordIndex>(w_ind);
+}
+
+inline size_t getUniqLen(WordUniq uniq){
+    return static_cast<size_t>(uniq >> 32);
+}
+
+inline WordIndex getUniqInd(WordUniq uniq){
+    return static_cast<WordIndex>(uniq);
+}
+
+// Index in ClueIndex::clues of length of word of random clue of word, there
+// is at least one clue for every word
+inline uint32_t getRandClueIndex(const ClueIndex &clues, WordUniq uniq){
+    const ClueRange &r = clues.ranges.at(getUniqLen(uniq)).at(getUniqInd(uniq));
+    return r.first + rand() % (r.last - r.first);
+}
+
+// Random clue of word
+inline std::u32string getRandClue(const ClueIndex &clues, WordUniq uniq){
+    return clues.text->get(clues.clues.at(getUniqLen(uniq))[getRandClueIndex(clues, uniq)]);
 }
 
+// Slot on explicit stack of backtracking. Candidates of slot are visited
+// cyclically from word rand_add, lookahead candidates are tried first
+struct SearchFrame {
+    static const WordIndex NO_WORD = 0xFFFFFFFF;
+    
+    uint32_t  rand_add;
+    uint32_t  order;      // key of shuffle of candidates after restart, 0 keeps order of scores
+    uint32_t  pos;        // next position in candidates
+    uint32_t  looked;     // candidates looked at
+    uint32_t  ranked_pos; // next candidate of lookahead
+    WordIndex word;       // word in slot, NO_WORD if slot is empty
+    // Derived from letters of slot when frame is opened
+    uint32_t  count;      // number of candidates
+    bool      use_dawg;   // candidates are words of automaton, not whole bucket
+    bool      need_match; // candidates must be matched with letters of slot
+};
+
+// Everything to continue backtracking of generateCrossIds exactly where it
+// stopped: restart, random generator of search and stack of filled slots.
+// Slots are filled in order of generateWordInfo, and used words and letters of
+// grid are words of frames, so they aren't stored
+struct SearchCheckpoint {
+    uint64_t                               key;        // getSearchKey of grid, dictionary and options
+    uint64_t                               attempt;    // restart, from 1
+    uint64_t                               nodes;      // visited nodes of all attempts
+    uint64_t                               node_limit; // nodes when attempt is stopped
+    uint64_t                               rng;        // state of random generator of search
+    std::vector< SearchFrame >             frames;     // frames of slots from the first one
+    std::vector< std::vector< uint64_t > > ranked;     // candidates of lookahead of frames
+    
+    SearchCheckpoint(): key(0), attempt(0), nodes(0), node_limit(0), rng(0) {}
+};
+
+// Checkpoint file is "CROSSCK2", numbers of SearchCheckpoint, uint32 number of
+// frames, fields of frames from rand_add to word, and for every frame uint32
+// number of ranked candidates and candidates. Numbers are little-endian. File
+// is written to path.tmp and then renamed, so crash leaves old checkpoint
+bool writeSearchCheckpoint(const std::string &path, const SearchCheckpoint &cp);
+// Returns false if file cannot be read or it isn't checkpoint
+bool readSearchCheckpoint(const std::string &path, SearchCheckpoint &cp_out);
+
+// State of running generation, it can be read and changed from other threads
+struct GenerateControl {
+    // on_progress is called from generating thread every (PROGRESS_MASK+1) nodes
+    static const uint64_t PROGRESS_MASK = (1 << 14) - 1;
+    
+    std::atomic<bool>     cancel;
+    std::atomic<uint64_t> nodes;      // number of visited search nodes
+    std::atomic<size_t>   best_depth; // max number of placed words
+    std::function< void(const GenerateControl&) > on_progress;
+    
+    // Limits of one attempt of procCross, they are set by generateCrossIds on
+    // restarts. Search stops when nodes reaches node_limit (0 is no limit),
+    // every slot starts from random word of rand_window best ones. If shuffle
+    // is set, candidates of every slot are also shuffled by blocks of near
+    // scores and ties of lookahead are broken randomly
+    uint64_t              node_limit;
+    size_t                rand_window;
+    bool                  shuffle;
+    
+    // Number of the first candidates of slot which are tried in order of
+    // options they leave to crossing slots, 0 disables lookahead. It needs
+    // automatons (buildWordsDawgs) to count matching words
+    size_t                lookahead;
+    
+    // Backtracking of generateCrossIds gives its state to on_checkpoint every
+    // (PROGRESS_MASK+1) nodes and when it is cancelled. It is called from
+    // generating thread, saving is up to it
+    std::function< void(const SearchCheckpoint&) > on_checkpoint;
+    // Next generateCrossIds continues search from it if its key fits, then
+    // it is reset to nullptr. Checkpoint isn't copied
+    const SearchCheckpoint *resume;
+    
+    GenerateControl(): cancel(false), nodes(0), best_depth(0), node_limit(0), rand_window(8),
+        shuffle(false), lookahead(0), resume(nullptr) {}
+    
+    void reset() {
+        cancel     = false;
+        nodes      = 0;
+        best_depth = 0;
+    }
+};
+
+template <class TChar>
 bool procCross(
         UsedWords used,
-        const AllWordsType &words,
-        WorkGridType grid, 
+        const WordsStorageT<TChar> &words,
+        WorkGridT<TChar> grid, 
         const std::vector<WordInfo> &winfos,
         const size_t cur_word_ind,
-        std::vector<TransedWord> &out
+        std::vector<WordUniq> &out,
+        GenerateControl *ctrl = nullptr,
+        const WordsDawgsT<TChar> *dawgs = nullptr
 );
 
+// Scratch memory of backtracking, it is reused by next generations
+template <class TChar>
+struct SearchScratch {
+    WorkGridT<TChar>                        grid;
+    std::vector< std::vector< uint8_t > >   used;     // marks of used words, layout of storage
+    std::vector< std::vector< WordIndex > > cands;    // candidates of slots
+    std::vector< TransedWordT< TChar > >    patterns; // letters of slots before they are filled
+    std::vector< WordUniq >                 path;     // words of slots
+    std::vector< std::vector< uint64_t > >  ranked;   // candidates of lookahead with ranks
+    std::vector< TransedWordT< TChar > >    crossing; // letters of crossing slots for lookahead
+    std::vector< SearchFrame >              frames;   // stack of search, frame of every slot
+    size_t                                  depth;    // slot to fill next, frames below it have words
+    uint64_t                                rng;      // random generator of search, unlike rand() it is saved
+    uint64_t                                attempt;  // restart of generateCrossIds
+    SearchCheckpoint                        checkpoint; // buffer for on_checkpoint
+    
+    SearchScratch(): depth(0), rng(0), attempt(0) {}
+    
+    // Clears marks and makes buffers for depth slots, capacity is kept
+    void prepare(const WordsStorageT<TChar> &words, size_t depth);
+    size_t memoryUsage() const;
+};
+
+// ids_out is empty if crossword cannot be generated or generation is cancelled.
+// Ids are in order of generateWordInfo
+void generateCrossIds(const CompiledGrid &cgrid, const AllWordsType &words,
+    std::vector<WordUniq> &ids_out, GenerateControl *ctrl = nullptr);
+// The same for grid which isn't compiled
+void generateCrossIds(const GridType &grid, const AllWordsType &words,
+    std::vector<WordUniq> &ids_out, GenerateControl *ctrl = nullptr);
+
+// Checkpoint of search can be resumed only with the same grid, lengths of
+// buckets of its slots, automatons and lookahead, they are hashed to key
+uint64_t getSearchKey(const CompiledGrid &cgrid, const AllWordsType &words, size_t lookahead);
+
+// Search used by generateCrossIds
+enum class SolverEngine {
+    Backtracking, // procCross, it is complete and is good for small grids
+    LocalSearch   // generateCrossIdsLocal, it is for big grids
+};
+
+// Names are "backtracking" and "local"
+bool parseSolverEngine(const std::string &name, SolverEngine &engine_out);
+
+void generateCrossIds(const CompiledGrid &cgrid, const AllWordsType &words, SolverEngine engine,
+    std::vector<WordUniq> &ids_out, GenerateControl *ctrl = nullptr);
+
+// Solves again slots with indexes from unlock (in order of generateWordInfo)
+// and slots crossing them, answers of other slots stay pinned. Previous
+// answers of unlocked slots aren't used. If region cannot be filled, it grows
+// by crossing slots up to whole grid. ids_out is empty if crossword cannot be
+// generated or generation is cancelled
+void regenerateCrossIds(const CompiledGrid &cgrid, const AllWordsType &words,
+    const std::vector<WordUniq> &ids, const std::vector<size_t> &unlock,
+    std::vector<WordUniq> &ids_out, GenerateControl *ctrl = nullptr);
+
+// Point of quality-vs-time curve of anytime search
+struct BestCrossPoint {
+    long long time_us; // since start of search
+    long long score;   // getCrossScore of fill
+    uint64_t  nodes;   // visited search nodes
+};
+
+// Anytime search of fill with maximal sum of word scores. It goes on until
+// budget_ms passes, search space is exhausted or generation is cancelled,
+// branches which can't beat the best fill are pruned. ids_out is the best fill
+// found (empty if none), every improvement is appended to curve. Returns true
+// if search is finished, so the fill is optimal
+bool generateBestCrossIds(const CompiledGrid &cgrid, const AllWordsType &words, long long budget_ms,
+    std::vector<WordUniq> &ids_out, std::vector<BestCrossPoint> *curve = nullptr,
+    GenerateControl *ctrl = nullptr);
+
+// Sum of scores of words, it is maximized by generateBestCrossIds
+long long getCrossScore(const AllWordsType &words, const std::vector<WordUniq> &ids);
+
+void getWordsByIds(const AllWordsType &words, const CharsTransType &trans_type,
+    const std::vector<WordUniq> &ids, std::vector<std::u32string> &words_out);
+
+// Reusable generator for one dictionary: scratch memory of backtracking is
+// kept between generations, so batch of crosswords allocates almost nothing
+// after the first one. It isn't an arena, buffers are vectors keeping their
+// capacity. generate and generateBest use it, regenerateCrossIds allocates its
+// own memory on every call.
+// Dictionary must outlive context, one context can't be used by two threads
+class GenerateContext {
+protected:
+    const AllWordsType                     &_words;
+    const CharsTransType                   &_trans;
+    SearchScratch< TransedChar >           _narrow;
+    SearchScratch< WideTransedChar >       _wide;
+
+public:
+    GenerateContext(const AllWordsType &words, const CharsTransType &trans);
+    
+    // The same as generateCrossIds
+    void generate(const CompiledGrid &cgrid, std::vector<WordUniq> &ids_out,
+        GenerateControl *ctrl = nullptr);
+    // The same as generateBestCrossIds
+    bool generateBest(const CompiledGrid &cgrid, long long budget_ms, std::vector<WordUniq> &ids_out,
+        std::vector<BestCrossPoint> *curve = nullptr, GenerateControl *ctrl = nullptr);
+    // The same as getWordsByIds, strings of words_out are reused
+    void getWords(const std::vector<WordUniq> &ids, std::vector<std::u32string> &words_out) const;
+    
+    // Bytes of scratch memory
+    size_t memoryUsage() const;
+};
+
+// generateCrossIds + getWordsByIds
 void generateCross(const GridType &grid, const AllWordsType &words, 
-    const CharsTransType &trans_type, std::vector<wxString> &words_out);
+    const CharsTransType &trans_type, std::vector<std::u32string> &words_out,
+    GenerateControl *ctrl = nullptr);
 
 template <class InputIterator>
 InputIterator getRandInterval(const InputIterator first, const InputIterator last){
@@ -0,0 +1,142 @@
+#include "crossgrid.hpp"
+
+#include <fstream>
+#include <iterator>
+
+#include "crossgen.hpp"
+#include "crosstrace.hpp"
+
+const uint32_t CompiledGrid::NO_SLOT;
+
+static const char   PACKED_MAGIC[]   = "CROSSPK1";
+static const size_t PACKED_MAGIC_LEN = 8;
+// Size and at least one byte of cells
+static const size_t MIN_PACKED_GRID_LEN = 5;
+
+void compileGrid(const GridType &grid, CompiledGrid &cgrid_out){
+    TraceScope trace("compileGrid");
+    CompiledGrid &cg = cgrid_out;
+    cg.grid   = grid;
+    cg.width  = grid.size();
+    cg.height = grid.at(0).size();
+    cg.winfos.clear();
+    generateWordInfo(grid, cg.winfos);
+    
+    // FNV-1a of size and clear cells
+    cg.hash = 14695981039346656037ULL;
+    auto mix = [&cg](uint64_t v) {
+        cg.hash = (cg.hash ^ v) * 1099511628211ULL;
+    };
+    mix(cg.width);
+    mix(cg.height);
+    for (auto &col: grid)
+        for (auto ch: col)
+            mix(ch == CELL_CLEAR);
+    
+    cg.slot_first.assign(1, 0);
+    cg.letter_cells.clear();
+    std::vector< uint32_t > cell_count(cg.width * cg.height + 1, 0);
+    for (auto &wi: cg.winfos) {
+        for (size_t j = 0; j < wi.len; ++j) {
+            uint32_t cell = static_cast<uint32_t>(wi.direct ?
+                (wi.x + j) * cg.height + wi.y : wi.x * cg.height + wi.y + j);
+            cg.letter_cells.push_back(cell);
+            ++cell_count[cell + 1];
+        }
+        cg.slot_first.push_back(static_cast<uint32_t>(cg.letter_cells.size()));
+    }
+    
+    cg.cell_first.resize(cell_count.size());
+    for (size_t c = 0; c < cell_count.size(); ++c)
+        cg.cell_first[c] = c == 0 ? 0 : cg.cell_first[c - 1] + cell_count[c];
+    cg.cell_slots.resize(cg.letter_cells.size());
+    std::vector< uint32_t > filled(cg.cell_first.begin(), cg.cell_first.end() - 1);
+    for (uint32_t i = 0; i < cg.winfos.size(); ++i)
+        for (uint32_t j = 0; j < cg.winfos[i].len; ++j) {
+            SlotPos sp = {i, j};
+            cg.cell_slots[filled[cg.cellOf(i, j)]++] = sp;
+        }
+    
+    SlotPos none = {CompiledGrid::NO_SLOT, 0};
+    cg.crosses.assign(cg.letter_cells.size(), none);
+    for (uint32_t i = 0; i < cg.winfos.size(); ++i)
+        for (uint32_t j = 0; j < cg.winfos[i].len; ++j) {
+            uint32_t cell = cg.cellOf(i, j);
+            for (uint32_t k = cg.cell_first[cell]; k < cg.cell_first[cell + 1]; ++k)
+                if ( cg.cell_slots[k].slot != i )
+                    cg.crosses[cg.slot_first[i] + j] = cg.cell_slots[k];
+        }
+}
+
+bool readGrid(const std::string &path, CompiledGrid &cgrid_out){
+    GridType grid;
+    if ( !readGrid(path, grid) )
+        return false;
+    compileGrid(grid, cgrid_out);
+    return true;
+}
+
+bool writePackedGrids(const std::string &path, const std::vector<GridType> &grids){
+    std::string data(PACKED_MAGIC, PACKED_MAGIC_LEN);
+    putLE(data, grids.size(), 4);
+    for (auto &grid: grids) {
+        if ( grid.empty() || (grid.size() > 0xFFFF) || (grid.at(0).size() > 0xFFFF) )
+            return false;
+        putLE(data, grid.size(), 2);
+        putLE(data, grid.at(0).size(), 2);
+        unsigned char byte = 0;
+        size_t        bits = 0;
+        for (auto &col: grid)
+            for (auto ch: col) {
+                byte |= (ch == CELL_CLEAR ? 1 : 0) << bits;
+                if ( ++bits == 8 ) {
+                    data += static_cast<char>(byte);
+                    byte = 0;
+                    bits = 0;
+                }
+            }
+        if ( bits > 0 )
+            data += static_cast<char>(byte);
+    }
+    std::ofstream f(path, std::ios::binary);
+    f.write(data.data(), data.size());
+    return static_cast<bool>(f);
+}
+
+bool readPackedGrids(const std::string &path, std::vector<CompiledGrid> &cgrids_out){
+    TraceScope trace("readPackedGrids");
+    std::ifstream f(path, std::ios::binary);
+    if ( !f )
+        return false;
+    std::string data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    if ( (data.size() < PACKED_MAGIC_LEN + 4) || (data.compare(0, PACKED_MAGIC_LEN, PACKED_MAGIC) != 0) )
+        return false;
+    
+    size_t pos   = PACKED_MAGIC_LEN;
+    size_t count = static_cast<size_t>(getLE(data, pos, 4));
+    pos += 4;
+    // Count of corrupt file isn't trusted, so it can't make huge allocation
+    if ( (data.size() - pos) / MIN_PACKED_GRID_LEN < count )
+        return false;
+    std::vector<CompiledGrid> cgrids(count);
+    GridType grid;
+    for (size_t g = 0; g < count; ++g) {
+        if ( pos + 4 > data.size() )
+            return false;
+        size_t width  = static_cast<size_t>(getLE(data, pos, 2));
+        size_t height = static_cast<size_t>(getLE(data, pos + 2, 2));
+        pos += 4;
+        size_t cells = width * height;
+        if ( (cells == 0) || (pos + (cells + 7) / 8 > data.size()) )
+            return false;
+        grid.assign(width, std::vector<char32_t>(height));
+        for (size_t c = 0; c < cells; ++c) {
+            bool is_clear = (static_cast<unsigned char>(data[pos + c / 8]) >> (c % 8)) & 1;
+            grid[c / height][c % height] = is_clear ? CELL_CLEAR : CELL_BORDER;
+        }
+        pos += (cells + 7) / 8;
+        compileGrid(grid, cgrids[g]);
+    }
+    cgrids_out.swap(cgrids);
+    return true;
+}
@@ -0,0 +1,62 @@
+#ifndef CROSSGRID_HPP
+#define CROSSGRID_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "crossbasetypes.hpp"
+
+// Letter pos of slot slot
+struct SlotPos {
+    uint32_t slot;
+    uint32_t pos;
+};
+
+// Grid with everything derived from it. It is built once after loading and is
+// shared by generation, preview and export. It isn't changed after building,
+// so one instance can be used by many threads. Cells are numbered x*height+y
+struct CompiledGrid {
+    static const uint32_t NO_SLOT = 0xFFFFFFFF;
+    
+    GridType                grid;
+    size_t                  width;
+    size_t                  height;
+    std::vector< WordInfo > winfos;       // slots in order of generateWordInfo
+    std::vector< uint32_t > slot_first;   // letters of slot i are [slot_first[i], slot_first[i+1])
+    std::vector< uint32_t > letter_cells; // cell of every letter
+    std::vector< SlotPos >  crosses;      // crossing letter of every letter, NO_SLOT if it is free
+    std::vector< uint32_t > cell_first;   // slots of cell c are cell_slots[cell_first[c], cell_first[c+1])
+    std::vector< SlotPos >  cell_slots;
+    uint64_t                hash;         // of size and clear cells
+    
+    CompiledGrid(): width(0), height(0), hash(0) {}
+    
+    bool empty() const {
+        return grid.empty();
+    }
+    
+    uint32_t cellOf(size_t slot, size_t pos) const {
+        return letter_cells[slot_first[slot] + pos];
+    }
+    
+    const SlotPos& crossOf(size_t slot, size_t pos) const {
+        return crosses[slot_first[slot] + pos];
+    }
+};
+
+// Grid must be rectangular and not empty
+void compileGrid(const GridType &grid, CompiledGrid &cgrid_out);
+
+// readGrid + compileGrid. Returns false if file cannot be read
+bool readGrid(const std::string &path, CompiledGrid &cgrid_out);
+
+// Packed file of many grids for batch jobs, it is read by one call. Format is
+// "CROSSPK1", uint32 number of grids and then for every grid uint16 width,
+// uint16 height and cells by columns, bit per cell (1 is clear cell) padded
+// to byte. Numbers are little-endian
+bool writePackedGrids(const std::string &path, const std::vector<GridType> &grids);
+// Returns false if file cannot be read or it isn't packed file of grids
+bool readPackedGrids(const std::string &path, std::vector<CompiledGrid> &cgrids_out);
+
+#endif // CROSSGRID_HPP
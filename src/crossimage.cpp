@@ -0,0 +1,351 @@
+#include "crossimage.hpp"
+
+#include <algorithm>
+#include <string>
+
+#include "crossexport.hpp"
+
+// Glyph of 5x7 font, bit 4 of row is the left pixel
+struct Glyph {
+    char32_t ch;
+    uint8_t  rows[7];
+};
+
+static const int GLYPH_WIDTH  = 5;
+static const int GLYPH_HEIGHT = 7;
+
+// Sorted by letters
+static const Glyph FONT[] = {
+    {U'0',   {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E}}, // 0
+    {U'1',   {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E}}, // 1
+    {U'2',   {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F}}, // 2
+    {U'3',   {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E}}, // 3
+    {U'4',   {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02}}, // 4
+    {U'5',   {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E}}, // 5
+    {U'6',   {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E}}, // 6
+    {U'7',   {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08}}, // 7
+    {U'8',   {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E}}, // 8
+    {U'9',   {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C}}, // 9
+    {U'A',   {0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}}, // A
+    {U'B',   {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E}}, // B
+    {U'C',   {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}}, // C
+    {U'D',   {0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C}}, // D
+    {U'E',   {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}}, // E
+    {U'F',   {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10}}, // F
+    {U'G',   {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F}}, // G
+    {U'H',   {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}}, // H
+    {U'I',   {0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}}, // I
+    {U'J',   {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C}}, // J
+    {U'K',   {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}}, // K
+    {U'L',   {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F}}, // L
+    {U'M',   {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11}}, // M
+    {U'N',   {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11}}, // N
+    {U'O',   {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}}, // O
+    {U'P',   {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10}}, // P
+    {U'Q',   {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D}}, // Q
+    {U'R',   {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11}}, // R
+    {U'S',   {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E}}, // S
+    {U'T',   {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}}, // T
+    {U'U',   {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}}, // U
+    {U'V',   {0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04}}, // V
+    {U'W',   {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A}}, // W
+    {U'X',   {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11}}, // X
+    {U'Y',   {0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04}}, // Y
+    {U'Z',   {0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F}}, // Z
+    {0x0401, {0x0A, 0x00, 0x1F, 0x10, 0x1E, 0x10, 0x1F}}, // Ё
+    {0x0410, {0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}}, // А
+    {0x0411, {0x1F, 0x10, 0x10, 0x1E, 0x11, 0x11, 0x1E}}, // Б
+    {0x0412, {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E}}, // В
+    {0x0413, {0x1F, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10}}, // Г
+    {0x0414, {0x06, 0x0A, 0x0A, 0x0A, 0x0A, 0x1F, 0x11}}, // Д
+    {0x0415, {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}}, // Е
+    {0x0416, {0x15, 0x15, 0x15, 0x0E, 0x15, 0x15, 0x15}}, // Ж
+    {0x0417, {0x0E, 0x11, 0x01, 0x06, 0x01, 0x11, 0x0E}}, // З
+    {0x0418, {0x11, 0x11, 0x13, 0x15, 0x19, 0x11, 0x11}}, // И
+    {0x0419, {0x0A, 0x04, 0x11, 0x13, 0x15, 0x19, 0x11}}, // Й
+    {0x041A, {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}}, // К
+    {0x041B, {0x07, 0x09, 0x09, 0x09, 0x09, 0x09, 0x11}}, // Л
+    {0x041C, {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11}}, // М
+    {0x041D, {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}}, // Н
+    {0x041E, {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}}, // О
+    {0x041F, {0x1F, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11}}, // П
+    {0x0420, {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10}}, // Р
+    {0x0421, {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}}, // С
+    {0x0422, {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}}, // Т
+    {0x0423, {0x11, 0x11, 0x11, 0x0F, 0x01, 0x11, 0x0E}}, // У
+    {0x0424, {0x04, 0x0E, 0x15, 0x15, 0x15, 0x0E, 0x04}}, // Ф
+    {0x0425, {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11}}, // Х
+    {0x0426, {0x12, 0x12, 0x12, 0x12, 0x12, 0x1F, 0x01}}, // Ц
+    {0x0427, {0x11, 0x11, 0x11, 0x0F, 0x01, 0x01, 0x01}}, // Ч
+    {0x0428, {0x15, 0x15, 0x15, 0x15, 0x15, 0x15, 0x1F}}, // Ш
+    {0x0429, {0x15, 0x15, 0x15, 0x15, 0x15, 0x1F, 0x01}}, // Щ
+    {0x042A, {0x18, 0x08, 0x08, 0x0E, 0x09, 0x09, 0x0E}}, // Ъ
+    {0x042B, {0x11, 0x11, 0x11, 0x1D, 0x13, 0x13, 0x1D}}, // Ы
+    {0x042C, {0x10, 0x10, 0x10, 0x1E, 0x11, 0x11, 0x1E}}, // Ь
+    {0x042D, {0x0E, 0x11, 0x01, 0x07, 0x01, 0x11, 0x0E}}, // Э
+    {0x042E, {0x12, 0x15, 0x15, 0x1D, 0x15, 0x15, 0x12}}, // Ю
+    {0x042F, {0x0F, 0x11, 0x11, 0x0F, 0x05, 0x09, 0x11}}, // Я
+};
+
+// Small letters are drawn as capital ones
+static const uint8_t* findGlyph(char32_t ch){
+    if ( (ch >= U'a') && (ch <= U'z') )
+        ch -= U'a' - U'A';
+    else if ( (ch >= 0x0430) && (ch <= 0x044F) )
+        ch -= 0x0430 - 0x0410;
+    else if ( ch == 0x0451 )
+        ch = 0x0401;
+    const Glyph *end = FONT + sizeof(FONT) / sizeof(FONT[0]);
+    const Glyph *g   = std::lower_bound(FONT, end, ch, [](const Glyph &a, char32_t b){
+        return a.ch < b;
+    });
+    return (g != end) && (g->ch == ch) ? g->rows : nullptr;
+}
+
+static void fillRect(CrossImage &image, size_t x, size_t y, size_t w, size_t h, uint8_t color){
+    for (size_t j = y; j < y + h; ++j)
+        std::fill_n(image.pixels.begin() + j * image.width + x, w, color);
+}
+
+// Every pixel of glyph is square of scale pixels
+static void drawGlyph(CrossImage &image, size_t x, size_t y, const uint8_t *rows, size_t scale){
+    for (int j = 0; j < GLYPH_HEIGHT; ++j)
+        for (int i = 0; i < GLYPH_WIDTH; ++i)
+            if ( rows[j] & (1 << (GLYPH_WIDTH - 1 - i)) )
+                fillRect(image, x + i * scale, y + j * scale, scale, scale, IMAGE_INK);
+}
+
+void getCrossImageSize(const FilledCrossword &cross, const ImageOptions &opts,
+        size_t &width_out, size_t &height_out){
+    const size_t w = cross.grid.size();
+    const size_t h = w > 0 ? cross.grid[0].size() : 0;
+    width_out  = w * opts.cell_size + 1;
+    height_out = h * opts.cell_size + 1;
+}
+
+void renderCross(const FilledCrossword &cross, const ImageOptions &opts, CrossImage &image,
+        size_t top){
+    const size_t w  = cross.grid.size();
+    const size_t h  = w > 0 ? cross.grid[0].size() : 0;
+    const size_t sq = static_cast<size_t>(std::max(opts.cell_size, 2));
+    // Cell is filled and framed, frames of neighbours overlap like in SVG
+    for (size_t y = 0; y < h; ++y)
+        for (size_t x = 0; x < w; ++x) {
+            if ( cross.grid[x][y] == CELL_BORDER )
+                continue;
+            const size_t left = x * sq, up = top + y * sq;
+            fillRect(image, left, up, sq + 1, sq + 1, IMAGE_INK);
+            fillRect(image, left + 1, up + 1, sq - 1, sq - 1, IMAGE_CELL);
+        }
+    
+    // Numbers take upper third of cell at most, letters take a half of it
+    const size_t num_scale = std::max<size_t>(1, sq / 24);
+    const size_t ans_scale = std::max<size_t>(1, sq / 14);
+    const size_t num_h = GLYPH_HEIGHT * num_scale;
+    for (auto &wi: cross.words) {
+        std::string num = std::to_string(wi.ind);
+        // Number which doesn't fit in cell isn't drawn, as letters
+        const size_t num_w = num.size() * (GLYPH_WIDTH + 1) * num_scale - num_scale;
+        if ( (num_w + 2 > sq) || (num_h + 2 > sq) )
+            continue;
+        size_t x = wi.x * sq + 2;
+        for (auto ch: num) {
+            drawGlyph(image, x, top + wi.y * sq + 2, findGlyph(static_cast<char32_t>(ch)), num_scale);
+            x += (GLYPH_WIDTH + 1) * num_scale;
+        }
+    }
+    if ( !opts.show_answers || (cross.ans.size() != cross.words.size()) || cross.ans.empty() )
+        return;
+    std::vector<char32_t> cells;
+    fillCells(cross, cells);
+    const size_t glyph_w = GLYPH_WIDTH * ans_scale, glyph_h = GLYPH_HEIGHT * ans_scale;
+    for (size_t y = 0; y < h; ++y)
+        for (size_t x = 0; x < w; ++x) {
+            char32_t ch = cells[y * w + x];
+            if ( (ch == CELL_BORDER) || (ch == CELL_CLEAR) )
+                continue;
+            const uint8_t *rows = findGlyph(ch);
+            if ( (rows == nullptr) || (glyph_w >= sq) || (glyph_h >= sq) )
+                continue;
+            // Letter is centered and lowered a little below number
+            size_t up = std::min(sq - glyph_h - 1, (sq - glyph_h) / 2 + sq / 10);
+            drawGlyph(image, x * sq + (sq - glyph_w + 1) / 2, top + y * sq + up, rows, ans_scale);
+        }
+}
+
+// Bits of deflate stream go from the lowest one
+class BitWriter {
+protected:
+    std::string &_out;
+    uint32_t     _bits;
+    int          _count;
+
+public:
+    explicit BitWriter(std::string &out): _out(out), _bits(0), _count(0) {}
+
+    void put(uint32_t value, int n) {
+        _bits  |= value << _count;
+        _count += n;
+        while ( _count >= 8 ) {
+            _out.push_back(static_cast<char>(_bits & 0xFF));
+            _bits  >>= 8;
+            _count  -= 8;
+        }
+    }
+
+    // Huffman codes are written from the highest bit
+    void putCode(uint32_t code, int n) {
+        uint32_t rev = 0;
+        for (int i = 0; i < n; ++i)
+            rev |= ((code >> i) & 1) << (n - 1 - i);
+        put(rev, n);
+    }
+
+    void flush() {
+        if ( _count > 0 )
+            _out.push_back(static_cast<char>(_bits & 0xFF));
+        _bits  = 0;
+        _count = 0;
+    }
+};
+
+// Symbol of fixed Huffman code of deflate
+static void putFixedSymbol(BitWriter &bw, uint32_t sym){
+    if ( sym < 144 )
+        bw.putCode(0x30 + sym, 8);
+    else if ( sym < 256 )
+        bw.putCode(0x190 + sym - 144, 9);
+    else if ( sym < 280 )
+        bw.putCode(sym - 256, 7);
+    else
+        bw.putCode(0xC0 + sym - 280, 8);
+}
+
+static void putMatch(BitWriter &bw, size_t len, size_t dist){
+    static const uint16_t LEN_BASE[]   = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27,
+        31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    static const uint8_t  LEN_EXTRA[]  = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+    static const uint16_t DIST_BASE[]  = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+        193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+    static const uint8_t  DIST_EXTRA[] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+    size_t l = std::upper_bound(LEN_BASE, LEN_BASE + 29, len) - LEN_BASE - 1;
+    putFixedSymbol(bw, static_cast<uint32_t>(257 + l));
+    bw.put(static_cast<uint32_t>(len - LEN_BASE[l]), LEN_EXTRA[l]);
+    size_t d = std::upper_bound(DIST_BASE, DIST_BASE + 30, dist) - DIST_BASE - 1;
+    bw.putCode(static_cast<uint32_t>(d), 5);
+    bw.put(static_cast<uint32_t>(dist - DIST_BASE[d]), DIST_EXTRA[d]);
+}
+
+static const size_t MIN_MATCH = 3;
+static const size_t MAX_MATCH = 258;
+static const size_t MAX_DIST  = 32768;
+
+// zlib stream of one block with fixed codes. Images are flat, so only two
+// distances are tried: 1 (run of one color) and row (the same upper row)
+static void deflateRows(const std::string &data, size_t row, std::string &out){
+    out.push_back(0x78);
+    out.push_back(0x01);
+    BitWriter bw(out);
+    bw.put(1, 1); // the last block
+    bw.put(1, 2); // fixed codes
+    auto matchLen = [&data](size_t pos, size_t dist) {
+        size_t n = 0, limit = std::min(MAX_MATCH, data.size() - pos);
+        while ( (n < limit) && (data[pos + n] == data[pos + n - dist]) )
+            ++n;
+        return n;
+    };
+    for (size_t pos = 0; pos < data.size(); ) {
+        size_t run = pos >= 1 ? matchLen(pos, 1) : 0;
+        size_t up  = (pos >= row) && (row <= MAX_DIST) ? matchLen(pos, row) : 0;
+        size_t len = std::max(run, up);
+        if ( len < MIN_MATCH ) {
+            putFixedSymbol(bw, static_cast<uint8_t>(data[pos]));
+            ++pos;
+            continue;
+        }
+        putMatch(bw, len, up >= run ? row : 1);
+        pos += len;
+    }
+    putFixedSymbol(bw, 256);
+    bw.flush();
+    
+    // Adler-32, sums don't overflow during 5552 bytes, so modulo is taken once per block
+    uint32_t a = 1, b = 0;
+    for (size_t from = 0; from < data.size(); from += 5552) {
+        size_t to = std::min(data.size(), from + 5552);
+        for (size_t i = from; i < to; ++i) {
+            a += static_cast<uint8_t>(data[i]);
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    uint32_t adler = (b << 16) | a;
+    for (int i = 3; i >= 0; --i)
+        out.push_back(static_cast<char>((adler >> (8 * i)) & 0xFF));
+}
+
+struct Crc32Table {
+    uint32_t values[256];
+
+    Crc32Table() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k)
+                c = c & 1 ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+            values[i] = c;
+        }
+    }
+};
+
+static uint32_t getCrc32(const std::string &data, size_t from){
+    static const Crc32Table table;
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = from; i < data.size(); ++i)
+        crc = table.values[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFF;
+}
+
+static void putBE32(std::string &out, uint32_t v){
+    for (int i = 3; i >= 0; --i)
+        out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+}
+
+static void putChunk(std::ostream &out, const char *type, const std::string &data){
+    std::string chunk;
+    putBE32(chunk, static_cast<uint32_t>(data.size()));
+    chunk.append(type, 4);
+    chunk += data;
+    putBE32(chunk, getCrc32(chunk, 4));
+    out.write(chunk.data(), chunk.size());
+}
+
+void writePng(const CrossImage &image, std::ostream &out){
+    static const char SIGNATURE[] = "\x89PNG\r\n\x1a\n";
+    out.write(SIGNATURE, 8);
+    
+    std::string header;
+    putBE32(header, static_cast<uint32_t>(image.width));
+    putBE32(header, static_cast<uint32_t>(image.height));
+    header.push_back(8); // bits per pixel
+    header.push_back(3); // palette
+    header.append(3, '\0');
+    putChunk(out, "IHDR", header);
+    // Colors of ImageColor
+    static const char PALETTE[] = "\xFF\xFF\xFF" "\xD9\xE7\xC8" "\x00\x00\x00";
+    putChunk(out, "PLTE", std::string(PALETTE, 9));
+    
+    // Every row starts with filter 0 (none)
+    std::string rows;
+    rows.reserve((image.width + 1) * image.height);
+    for (size_t y = 0; y < image.height; ++y) {
+        rows.push_back('\0');
+        rows.append(reinterpret_cast<const char*>(image.pixels.data() + y * image.width), image.width);
+    }
+    std::string data;
+    deflateRows(rows, image.width + 1, data);
+    putChunk(out, "IDAT", data);
+    putChunk(out, "IEND", std::string());
+}
@@ -0,0 +1,55 @@
+#ifndef CROSSIMAGE_HPP
+#define CROSSIMAGE_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "crossbasetypes.hpp"
+
+// Raster images of crosswords without GUI and display, they are drawn by
+// built-in bitmap font of digits, Latin and Cyrillic letters. Letters of
+// other alphabets aren't drawn, SVG export has them
+
+struct ImageOptions {
+    int  cell_size;    // side of cell in pixels
+    bool show_answers;
+
+    ImageOptions(): cell_size(32), show_answers(true) {}
+};
+
+// Colors of pixels are indexes in palette
+enum ImageColor {
+    IMAGE_BACK = 0, // outside of grid
+    IMAGE_CELL = 1, // clear cell
+    IMAGE_INK  = 2  // lines, numbers and letters
+};
+
+struct CrossImage {
+    size_t                 width;
+    size_t                 height;
+    std::vector< uint8_t > pixels; // rows one after another
+
+    CrossImage(): width(0), height(0) {}
+
+    // Reuses memory, all pixels become IMAGE_BACK
+    void reset(size_t w, size_t h) {
+        width  = w;
+        height = h;
+        pixels.assign(w * h, IMAGE_BACK);
+    }
+};
+
+// Size of image of crossword in pixels
+void getCrossImageSize(const FilledCrossword &cross, const ImageOptions &opts,
+    size_t &width_out, size_t &height_out);
+
+// Draws crossword with top left corner at (0, top), image must have place for it.
+// Numbers and letters too big for cells of small size are skipped
+void renderCross(const FilledCrossword &cross, const ImageOptions &opts, CrossImage &image,
+    size_t top = 0);
+
+// PNG with palette, rows are compressed by runs and copies of upper row
+void writePng(const CrossImage &image, std::ostream &out);
+
+#endif // CROSSIMAGE_HPP
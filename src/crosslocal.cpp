@@ -0,0 +1,205 @@
+#include "crosslocal.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <unordered_map>
+
+#include "crossgen.hpp"
+#include "crosstrace.hpp"
+
+// Steps of local search per slot before it gives up
+static const size_t LOCAL_STEPS_PER_SLOT = 2000;
+// Probability (in percents) of random word instead of the best one
+static const int    LOCAL_NOISE_PERCENT  = 10;
+
+static const WordIndex NO_WORD = std::numeric_limits<WordIndex>::max();
+
+template <class TChar>
+struct LocalSearch {
+    const WordsStorageT<TChar>                  &words;
+    const WordsDawgsT<TChar>                    *dawgs;
+    const CompiledGrid                          &cgrid;
+    const std::vector<WordInfo>                 &winfos;
+    std::vector< WordIndex >                    assigned; // NO_WORD if slot is empty
+    std::vector< size_t >                       conflicts;
+    // Slots with word. Duplicate of word is conflict of all its slots, they
+    // don't have to cross
+    std::unordered_map< WordUniq, std::vector<size_t> > holders;
+    
+    LocalSearch(const WordsStorageT<TChar> &words_, const WordsDawgsT<TChar> *dawgs_,
+        const CompiledGrid &cgrid_):
+        words(words_), dawgs(dawgs_), cgrid(cgrid_), winfos(cgrid_.winfos) {}
+    
+    TChar letter(size_t slot, size_t pos) const {
+        if ( assigned[slot] == NO_WORD )
+            return TRANS_CLEAR;
+        return words[winfos[slot].len][assigned[slot]][pos];
+    }
+    
+    // Letters of crossing slots, TRANS_CLEAR if letter isn't crossed or crossing slot is empty
+    void pattern(size_t slot, TransedWordT<TChar> &pattern_out) const {
+        pattern_out.resize(winfos[slot].len);
+        for (size_t j = 0; j < pattern_out.size(); ++j) {
+            const SlotPos &c = cgrid.crossOf(slot, j);
+            pattern_out[j] = c.slot == CompiledGrid::NO_SLOT ? TRANS_CLEAR : letter(c.slot, c.pos);
+        }
+    }
+    
+    // Conflicts of word in slot, self_uses is 1 if word is already in slot
+    size_t wordConflicts(size_t slot, WordIndex ind, const TransedWordT<TChar> &pattern,
+            size_t self_uses) const {
+        const TransedWordT<TChar> &word = words[winfos[slot].len][ind];
+        size_t res = 0;
+        for (size_t j = 0; j < word.size(); ++j)
+            if ( (pattern[j] != TRANS_CLEAR) && (pattern[j] != word[j]) )
+                ++res;
+        auto it = holders.find(getWordUniq(static_cast<size_t>(ind), winfos[slot].len));
+        if ( (it != holders.end()) && (it->second.size() > self_uses) )
+            ++res;
+        return res;
+    }
+    
+    void updateConflicts(size_t slot) {
+        if ( assigned[slot] == NO_WORD ) {
+            conflicts[slot] = 0;
+            return;
+        }
+        TransedWordT<TChar> p;
+        pattern(slot, p);
+        conflicts[slot] = wordConflicts(slot, assigned[slot], p, 1);
+    }
+    
+    // Conflicts are updated for slot, slots crossing it and other slots with
+    // its old and new words
+    void assign(size_t slot, WordIndex ind) {
+        const size_t len = winfos[slot].len;
+        const std::vector<size_t> *old_holders = nullptr;
+        if ( assigned[slot] != NO_WORD ) {
+            auto it = holders.find(getWordUniq(static_cast<size_t>(assigned[slot]), len));
+            std::vector<size_t> &h = it->second;
+            h.erase(std::find(h.begin(), h.end(), slot));
+            if ( h.empty() )
+                holders.erase(it);
+            else
+                old_holders = &h;
+        }
+        assigned[slot] = ind;
+        std::vector<size_t> &new_holders = holders[getWordUniq(static_cast<size_t>(ind), len)];
+        new_holders.push_back(slot);
+        // References to elements of unordered_map stay valid after insertion
+        if ( old_holders != nullptr )
+            for (auto other: *old_holders)
+                updateConflicts(other);
+        for (auto other: new_holders)
+            updateConflicts(other);
+        for (size_t j = 0; j < len; ++j)
+            if ( cgrid.crossOf(slot, j).slot != CompiledGrid::NO_SLOT )
+                updateConflicts(cgrid.crossOf(slot, j).slot);
+    }
+    
+    // Word with minimal number of conflicts in slot, ties are broken randomly.
+    // Automaton gives words without conflicts of letters at once, then words
+    // with one wrong letter, and only then the whole bucket is scanned
+    WordIndex chooseWord(size_t slot) const {
+        const size_t len = winfos[slot].len;
+        TransedWordT<TChar> p;
+        pattern(slot, p);
+        size_t best = std::numeric_limits<size_t>::max();
+        std::vector< WordIndex > best_inds;
+        auto consider = [&](WordIndex ind) {
+            if ( ind == assigned[slot] )
+                return;
+            size_t c = wordConflicts(slot, ind, p, 0);
+            if ( c < best ) {
+                best = c;
+                best_inds.clear();
+            }
+            if ( c == best )
+                best_inds.push_back(ind);
+        };
+        
+        bool use_dawg = (dawgs != nullptr) && (len < dawgs->size()) && !(*dawgs)[len].empty() &&
+            std::any_of(p.begin(), p.end(), [](TChar ch){ return ch != TRANS_CLEAR; });
+        if ( use_dawg ) {
+            std::vector< WordIndex > cands;
+            (*dawgs)[len].match(p, cands);
+            for (auto ind: cands)
+                consider(ind);
+            for (size_t j = 0; (j < len) && (best > 1); ++j) {
+                if ( p[j] == TRANS_CLEAR )
+                    continue;
+                TransedWordT<TChar> relaxed(p);
+                relaxed[j] = TRANS_CLEAR;
+                cands.clear();
+                (*dawgs)[len].match(relaxed, cands);
+                for (auto ind: cands)
+                    consider(ind);
+            }
+        }
+        if ( !use_dawg || (best > 1) )
+            for (size_t i = 0; i < words[len].size(); ++i)
+                consider(static_cast<WordIndex>(i));
+        if ( best_inds.empty() )
+            return assigned[slot];
+        return best_inds[rand() % best_inds.size()];
+    }
+};
+
+template <class TChar>
+static void generateCrossLocalT(const CompiledGrid &cgrid, const WordsStorageT<TChar> &words,
+    const WordsDawgsT<TChar> &dawgs, std::vector<WordUniq> &ids_out, GenerateControl *ctrl){
+    TraceScope trace("generateCrossLocal");
+    
+    ids_out.clear();
+    const std::vector<WordInfo> &winfos = cgrid.winfos;
+    for (auto &wi: winfos)
+        if ( (wi.len >= words.size()) || words[wi.len].empty() )
+            return;
+    
+    LocalSearch<TChar> s(words, dawgs.empty() ? nullptr : &dawgs, cgrid);
+    s.assigned.assign(winfos.size(), NO_WORD);
+    s.conflicts.assign(winfos.size(), 0);
+    
+    // Greedy start: every slot gets the best word for slots before it
+    for (size_t i = 0; i < winfos.size(); ++i)
+        s.assign(i, s.chooseWord(i));
+    
+    const size_t max_steps = LOCAL_STEPS_PER_SLOT * winfos.size();
+    std::vector< size_t > bad;
+    for (size_t step = 0; step < max_steps; ++step) {
+        bad.clear();
+        for (size_t i = 0; i < winfos.size(); ++i)
+            if ( s.conflicts[i] > 0 )
+                bad.push_back(i);
+        if ( ctrl != nullptr ) {
+            if ( ctrl->cancel )
+                return;
+            if ( winfos.size() - bad.size() > ctrl->best_depth )
+                ctrl->best_depth = winfos.size() - bad.size();
+            if ( ((++ctrl->nodes & GenerateControl::PROGRESS_MASK) == 0) && ctrl->on_progress )
+                ctrl->on_progress(*ctrl);
+        }
+        if ( bad.empty() )
+            break;
+        
+        size_t slot = bad[rand() % bad.size()];
+        if ( rand() % 100 < LOCAL_NOISE_PERCENT )
+            s.assign(slot, static_cast<WordIndex>(rand() % words[winfos[slot].len].size()));
+        else
+            s.assign(slot, s.chooseWord(slot));
+    }
+    if ( std::any_of(s.conflicts.begin(), s.conflicts.end(), [](size_t c){ return c > 0; }) )
+        return;
+    
+    for (size_t i = 0; i < winfos.size(); ++i)
+        ids_out.push_back(getWordUniq(static_cast<size_t>(s.assigned[i]), winfos[i].len));
+}
+
+void generateCrossIdsLocal(const CompiledGrid &cgrid, const AllWordsType &words,
+    std::vector<WordUniq> &ids_out, GenerateControl *ctrl){
+    if ( words.wide )
+        generateCrossLocalT(cgrid, words.wide_words, words.wide_dawgs, ids_out, ctrl);
+    else
+        generateCrossLocalT(cgrid, words.narrow_words, words.narrow_dawgs, ids_out, ctrl);
+}
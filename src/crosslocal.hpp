@@ -0,0 +1,21 @@
+#ifndef CROSSLOCAL_HPP
+#define CROSSLOCAL_HPP
+
+#include <vector>
+
+#include "crossbasetypes.hpp"
+#include "crossgrid.hpp"
+
+struct GenerateControl;
+
+// Local search (min-conflicts with random walk) for big grids where
+// backtracking blows up. It starts from full greedy assignment of words to
+// slots and replaces words of conflicting slots until no letters of crossing
+// slots differ and no word is used twice. Automatons of words are used to
+// find candidates if they are built. ids_out is empty if there are still
+// conflicts after limit of steps or generation is cancelled. Ids are in
+// order of generateWordInfo
+void generateCrossIdsLocal(const CompiledGrid &cgrid, const AllWordsType &words,
+    std::vector<WordUniq> &ids_out, GenerateControl *ctrl = nullptr);
+
+#endif // CROSSLOCAL_HPP
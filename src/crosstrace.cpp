@@ -0,0 +1,95 @@
+#include "crosstrace.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic< bool > trace_enabled(false);
+
+struct TraceEvent {
+    const char *name;
+    int64_t     start_us;
+    int64_t     dur_us;
+};
+
+// Events of one thread, only this thread writes them. Ring grows up to
+// TRACE_RING_SIZE, so short threads take little memory
+struct TraceRing {
+    uint32_t                  tid;
+    const char                *name;
+    std::vector< TraceEvent > events;
+    uint64_t                  count; // events ever added, events[count % size] is the oldest
+};
+
+static std::chrono::steady_clock::time_point      trace_start;
+static std::mutex                                 rings_mutex;
+static std::vector< std::unique_ptr<TraceRing> > rings;
+// Rings live until exit, so they are kept after end of their threads
+static thread_local TraceRing                    *thread_ring = nullptr;
+
+static TraceRing& getThreadRing(){
+    if ( thread_ring == nullptr ) {
+        std::lock_guard< std::mutex > lock(rings_mutex);
+        rings.push_back(std::unique_ptr<TraceRing>(new TraceRing()));
+        thread_ring        = rings.back().get();
+        thread_ring->tid   = static_cast<uint32_t>(rings.size() - 1);
+        thread_ring->name  = nullptr;
+        thread_ring->count = 0;
+    }
+    return *thread_ring;
+}
+
+void enableTrace(bool enable){
+    if ( enable && !isTraceEnabled() )
+        trace_start = std::chrono::steady_clock::now();
+    trace_enabled.store(enable, std::memory_order_release);
+}
+
+int64_t getTraceTime(){
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - trace_start).count();
+}
+
+void addTraceEvent(const char *name, int64_t start_us, int64_t end_us){
+    TraceRing &ring = getThreadRing();
+    TraceEvent ev = {name, start_us, end_us - start_us};
+    if ( ring.events.size() < TRACE_RING_SIZE )
+        ring.events.push_back(ev);
+    else
+        ring.events[ring.count % TRACE_RING_SIZE] = ev;
+    ++ring.count;
+}
+
+void setTraceThreadName(const char *name){
+    getThreadRing().name = name;
+}
+
+bool writeTrace(const std::string &path){
+    std::ofstream f(path, std::ios::binary);
+    if ( !f )
+        return false;
+    std::lock_guard< std::mutex > lock(rings_mutex);
+    f << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (auto &ring: rings) {
+        if ( ring->name != nullptr ) {
+            f << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+              << ring->tid << ",\"args\":{\"name\":\"" << ring->name << "\"}}";
+            first = false;
+        }
+        // Oldest event is the first one until ring is full
+        size_t size  = ring->events.size();
+        size_t begin = ring->count > size ? ring->count % size : 0;
+        for (size_t i = 0; i < size; ++i) {
+            const TraceEvent &ev = ring->events[(begin + i) % size];
+            f << (first ? "\n" : ",\n") << "{\"name\":\"" << ev.name
+              << "\",\"cat\":\"crossgen\",\"ph\":\"X\",\"ts\":" << ev.start_us
+              << ",\"dur\":" << ev.dur_us << ",\"pid\":1,\"tid\":" << ring->tid << "}";
+            first = false;
+        }
+    }
+    f << "\n]}\n";
+    return static_cast<bool>(f);
+}
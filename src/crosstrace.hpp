@@ -0,0 +1,54 @@
+#ifndef CROSSTRACE_HPP
+#define CROSSTRACE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Timeline of phases of generation (loading, sorting, search, export) in
+// Chrome trace-event format, it is opened by chrome://tracing or Perfetto.
+// Every thread records its events to its own ring without locks, when
+// tracing is disabled scope costs one load of flag
+
+// Events kept per thread, older ones are overwritten
+const size_t TRACE_RING_SIZE = 1 << 16;
+
+extern std::atomic< bool > trace_enabled;
+
+inline bool isTraceEnabled(){
+    return trace_enabled.load(std::memory_order_acquire);
+}
+
+void enableTrace(bool enable);
+
+// Microseconds since tracing was enabled
+int64_t getTraceTime();
+
+// Name must be a string literal, only pointer is kept
+void addTraceEvent(const char *name, int64_t start_us, int64_t end_us);
+
+// Name of current thread in timeline, it must be a string literal too
+void setTraceThreadName(const char *name);
+
+// Writes events of all threads as JSON, threads must not record events
+// during writing
+bool writeTrace(const std::string &path);
+
+// Records time from construction to destruction as one event
+class TraceScope {
+protected:
+    const char *_name;
+    int64_t     _start; // -1 if tracing was disabled
+
+public:
+    explicit TraceScope(const char *name):
+        _name(name), _start(isTraceEnabled() ? getTraceTime() : -1) {}
+    ~TraceScope(){
+        if ( _start >= 0 )
+            addTraceEvent(_name, _start, getTraceTime());
+    }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+};
+
+#endif // CROSSTRACE_HPP
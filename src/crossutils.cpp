@@ -0,0 +1,197 @@
+#include "crossutils.hpp"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+std::u32string fromUtf8(const std::string &s){
+    return fromUtf8(s.data(), s.size());
+}
+
+std::u32string fromUtf8(const char *s, size_t len){
+    std::u32string res;
+    res.reserve(len);
+    for (size_t i = 0; i < len; ){
+        unsigned char ch = s[i];
+        size_t    tail;
+        char32_t  cp;
+        if ( ch < 0x80 ) {
+            tail = 0;
+            cp   = ch;
+        } else if ( (ch & 0xE0) == 0xC0 ) {
+            tail = 1;
+            cp   = ch & 0x1F;
+        } else if ( (ch & 0xF0) == 0xE0 ) {
+            tail = 2;
+            cp   = ch & 0x0F;
+        } else if ( (ch & 0xF8) == 0xF0 ) {
+            tail = 3;
+            cp   = ch & 0x07;
+        } else {
+            // Broken byte, skipping it
+            ++i;
+            continue;
+        }
+        if ( i + tail >= len )
+            break;
+        ++i;
+        for (size_t j = 0; j < tail; ++j, ++i)
+            cp = (cp << 6) | (static_cast<unsigned char>(s[i]) & 0x3F);
+        res.push_back(cp);
+    }
+    return res;
+}
+
+std::string toUtf8(char32_t ch){
+    std::string res;
+    if ( ch < 0x80 ) {
+        res += static_cast<char>(ch);
+    } else if ( ch < 0x800 ) {
+        res += static_cast<char>(0xC0 | (ch >> 6));
+        res += static_cast<char>(0x80 | (ch & 0x3F));
+    } else if ( ch < 0x10000 ) {
+        res += static_cast<char>(0xE0 | (ch >> 12));
+        res += static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+        res += static_cast<char>(0x80 | (ch & 0x3F));
+    } else {
+        res += static_cast<char>(0xF0 | (ch >> 18));
+        res += static_cast<char>(0x80 | ((ch >> 12) & 0x3F));
+        res += static_cast<char>(0x80 | ((ch >> 6) & 0x3F));
+        res += static_cast<char>(0x80 | (ch & 0x3F));
+    }
+    return res;
+}
+
+std::string toUtf8(const std::u32string &s){
+    std::string res;
+    res.reserve(s.size());
+    for (auto ch: s)
+        res += toUtf8(ch);
+    return res;
+}
+
+std::u32string toU32(unsigned long long num){
+    std::string t = std::to_string(num);
+    return std::u32string(t.begin(), t.end());
+}
+
+void putUtf8(std::ostream &out, char32_t ch){
+    if ( ch < 0x80 ) {
+        out.put(static_cast<char>(ch));
+    } else if ( ch < 0x800 ) {
+        out.put(static_cast<char>(0xC0 | (ch >> 6)));
+        out.put(static_cast<char>(0x80 | (ch & 0x3F)));
+    } else if ( ch < 0x10000 ) {
+        out.put(static_cast<char>(0xE0 | (ch >> 12)));
+        out.put(static_cast<char>(0x80 | ((ch >> 6) & 0x3F)));
+        out.put(static_cast<char>(0x80 | (ch & 0x3F)));
+    } else {
+        out.put(static_cast<char>(0xF0 | (ch >> 18)));
+        out.put(static_cast<char>(0x80 | ((ch >> 12) & 0x3F)));
+        out.put(static_cast<char>(0x80 | ((ch >> 6) & 0x3F)));
+        out.put(static_cast<char>(0x80 | (ch & 0x3F)));
+    }
+}
+
+bool readLine(std::istream &in, std::string &line_out){
+    if ( !std::getline(in, line_out) )
+        return false;
+    if ( !line_out.empty() && (line_out.back() == '\r') )
+        line_out.pop_back();
+    return true;
+}
+
+void putLE(std::string &out, uint64_t v, size_t bytes){
+    for (size_t i = 0; i < bytes; ++i)
+        out += static_cast<char>((v >> (8 * i)) & 0xFF);
+}
+
+uint64_t getLE(const std::string &data, size_t pos, size_t bytes){
+    uint64_t res = 0;
+    for (size_t i = bytes; i-- > 0; )
+        res = (res << 8) | static_cast<unsigned char>(data[pos + i]);
+    return res;
+}
+
+size_t StringArena::hashBytes(const char *s, size_t len){
+    // FNV-1a
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < len; ++i){
+        h ^= static_cast<unsigned char>(s[i]);
+        h *= 1099511628211ULL;
+    }
+    return static_cast<size_t>(h);
+}
+
+StringArena::StringArena(const std::shared_ptr< const StringArena > &base):
+        _base(base), _baseSize(base->size()), _layers(base->_layers + 1){
+    if ( _layers <= MAX_LAYERS )
+        return;
+    // Strings and tables of all layers are copied, places stay the same
+    std::vector< const StringArena* > chain;
+    for (const StringArena *a = base.get(); a != nullptr; a = a->_base.get())
+        chain.push_back(a);
+    _data.reserve(_baseSize);
+    for (size_t i = chain.size(); i-- > 0; ) {
+        _data.append(chain[i]->_data);
+        _interned.insert(chain[i]->_interned.begin(), chain[i]->_interned.end());
+    }
+    _base.reset();
+    _baseSize = 0;
+    _layers   = 1;
+}
+
+bool StringArena::findInterned(const char *s, size_t len, size_t h, StrRef &ref_out) const{
+    for (const StringArena *a = this; a != nullptr; a = a->_base.get()) {
+        auto range = a->_interned.equal_range(h);
+        for (auto it = range.first; it != range.second; ++it)
+            if ( (it->second.len == len) && (std::memcmp(ptr(it->second), s, len) == 0) ) {
+                ref_out = it->second;
+                return true;
+            }
+    }
+    return false;
+}
+
+StrRef StringArena::add(const char *s, size_t len){
+    if ( size() + len > std::numeric_limits<uint32_t>::max() )
+        throw std::length_error("String arena is full");
+    StrRef ref;
+    ref.offset = static_cast<uint32_t>(size());
+    ref.len    = static_cast<uint32_t>(len);
+    _data.append(s, len);
+    return ref;
+}
+
+StrRef StringArena::intern(const char *s, size_t len){
+    size_t h = hashBytes(s, len);
+    StrRef ref;
+    if ( findInterned(s, len, h, ref) )
+        return ref;
+    ref = add(s, len);
+    _interned.insert(std::make_pair(h, ref));
+    return ref;
+}
+
+void StringArena::finish(){
+    std::unordered_multimap< size_t, StrRef >().swap(_interned);
+    _data.shrink_to_fit();
+}
+
+void StringArena::clear(){
+    _base.reset();
+    _baseSize = 0;
+    _layers   = 1;
+    _data.clear();
+    _interned.clear();
+}
+
+void crossLogDebugImpl(const char *fmt, ...){
+    va_list args;
+    va_start(args, fmt);
+    std::vfprintf(stderr, fmt, args);
+    va_end(args);
+    std::fputc('\n', stderr);
+}
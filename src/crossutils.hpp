@@ -0,0 +1,169 @@
+#ifndef CROSSUTILS_HPP
+#define CROSSUTILS_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <istream>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+// Engine works with UTF-32 strings and reads/writes files in UTF-8
+std::u32string fromUtf8(const std::string &s);
+
+std::u32string fromUtf8(const char *s, size_t len);
+
+std::string toUtf8(const std::u32string &s);
+
+std::string toUtf8(char32_t ch);
+
+std::u32string toU32(unsigned long long num);
+
+// Writes one character in UTF-8 without temporary strings
+void putUtf8(std::ostream &out, char32_t ch);
+
+// Reads one line without '\n' and '\r' at the end. Returns false at end of file
+bool readLine(std::istream &in, std::string &line_out);
+
+// Little-endian numbers of binary files, bytes is from 1 to 8. getLE
+// doesn't check bounds of data
+void putLE(std::string &out, uint64_t v, size_t bytes);
+uint64_t getLE(const std::string &data, size_t pos, size_t bytes);
+
+// Place of string in StringArena
+struct StrRef {
+    uint32_t offset;
+    uint32_t len;
+};
+
+// Strings in UTF-8 stored one after another in one buffer, so there is one
+// allocation instead of one per string. Equal strings added by intern() share
+// one place. Arena isn't changed after finish(), then it can be read from
+// many threads.
+// Arena can be a layer over shared base arena: strings of base keep their
+// places and new ones go after them, so base isn't copied
+class StringArena {
+public:
+    // Longer chain of layers is joined to one arena
+    static const size_t MAX_LAYERS = 8;
+
+protected:
+    std::shared_ptr< const StringArena >      _base;
+    size_t                                    _baseSize; // places below it are in base
+    size_t                                    _layers;   // arenas in chain with this one
+    std::string                               _data;
+    std::unordered_multimap< size_t, StrRef > _interned; // hash -> place, until finish()
+
+    static size_t hashBytes(const char *s, size_t len);
+
+    const char* ptr(StrRef ref) const {
+        const StringArena *a = this;
+        while ( ref.offset < a->_baseSize )
+            a = a->_base.get();
+        return a->_data.data() + (ref.offset - a->_baseSize);
+    }
+    // Interned string of this arena or its base layers
+    bool findInterned(const char *s, size_t len, size_t h, StrRef &ref_out) const;
+
+public:
+    StringArena(): _baseSize(0), _layers(1) {}
+    explicit StringArena(const std::shared_ptr< const StringArena > &base);
+
+    StrRef add(const char *s, size_t len);
+    StrRef intern(const char *s, size_t len);
+
+    std::u32string get(StrRef ref) const {
+        return fromUtf8(ptr(ref), ref.len);
+    }
+    std::string getUtf8(StrRef ref) const {
+        return std::string(ptr(ref), ref.len);
+    }
+    // Compares strings byte by byte, it is the same order as order of code points
+    int compare(StrRef a, StrRef b) const {
+        int res = std::memcmp(ptr(a), ptr(b), std::min(a.len, b.len));
+        return res != 0 ? res : (a.len < b.len ? -1 : (a.len > b.len ? 1 : 0));
+    }
+
+    // Drops table of interned strings and frees unused memory
+    void finish();
+    void clear();
+
+    size_t size() const {
+        return _baseSize + _data.size();
+    }
+};
+
+// Vector shared by copies until one of them is edited, then the edited copy
+// gets its own vector. Versions of dictionary share buckets this way
+template <class T>
+class SharedVector {
+protected:
+    std::shared_ptr< std::vector<T> > _v; // never nullptr, empty ones share one vector
+
+    static const std::shared_ptr< std::vector<T> >& emptyVector() {
+        static const std::shared_ptr< std::vector<T> > v = std::make_shared< std::vector<T> >();
+        return v;
+    }
+
+public:
+    typedef typename std::vector<T>::const_iterator const_iterator;
+
+    SharedVector(): _v(emptyVector()) {}
+    explicit SharedVector(std::vector<T> &&v): _v(std::make_shared< std::vector<T> >(std::move(v))) {}
+
+    operator const std::vector<T>&() const {
+        return *_v;
+    }
+    const std::vector<T>& get() const {
+        return *_v;
+    }
+    // Vector to change, it is copied first if it is shared
+    std::vector<T>& edit() {
+        if ( _v.use_count() > 1 )
+            _v = std::make_shared< std::vector<T> >(*_v);
+        return *_v;
+    }
+
+    size_t size() const {
+        return _v->size();
+    }
+    bool empty() const {
+        return _v->empty();
+    }
+    const T& operator[](size_t i) const {
+        return (*_v)[i];
+    }
+    const T& at(size_t i) const {
+        return _v->at(i);
+    }
+    const T& front() const {
+        return _v->front();
+    }
+    const T* data() const {
+        return _v->data();
+    }
+    const_iterator begin() const {
+        return _v->begin();
+    }
+    const_iterator end() const {
+        return _v->end();
+    }
+};
+
+void crossLogDebugImpl(const char *fmt, ...)
+#ifdef __GNUC__
+    __attribute__((format(printf, 1, 2)))
+#endif
+;
+
+// Prints message to stderr in debug builds only
+#ifdef NDEBUG
+    #define crossLogDebug(...) ((void)0)
+#else
+    #define crossLogDebug(...) crossLogDebugImpl(__VA_ARGS__)
+#endif
+
+#endif // CROSSUTILS_HPP
@@ -0,0 +1,26 @@
+#include "crosswx.hpp"
+
+wxString toWx(const std::u32string &s){
+    return wxString(toUtf8(s).c_str(), wxConvUTF8);
+}
+
+wxString toWx(char32_t ch){
+    return wxString(toUtf8(ch).c_str(), wxConvUTF8);
+}
+
+std::u32string fromWx(const wxString &s){
+    const wxCharBuffer buf = s.mb_str(wxConvUTF8);
+    return fromUtf8(buf.data());
+}
+
+std::string toStdPath(const wxString &path){
+    const wxCharBuffer buf = path.mb_str(wxConvUTF8);
+    return std::string(buf.data());
+}
+
+ExportTitles getTranslatedTitles(){
+    ExportTitles titles;
+    titles.vert = fromWx(_("Vertical words:"));
+    titles.hor  = fromWx(_("Horisontal words:"));
+    return titles;
+}
@@ -0,0 +1,21 @@
+#ifndef CROSSWX_HPP
+#define CROSSWX_HPP
+
+#include <string>
+#include <wx/wx.h>
+
+#include "crossexport.hpp"
+
+// Adapter between headless engine (UTF-32 strings, UTF-8 paths) and wxWidgets
+
+wxString toWx(const std::u32string &s);
+
+wxString toWx(char32_t ch);
+
+std::u32string fromWx(const wxString &s);
+
+std::string toStdPath(const wxString &path);
+
+ExportTitles getTranslatedTitles();
+
+#endif // CROSSWX_HPP
@@ -27,6 +27,10 @@ VMainFrame::VMainFrame( wxWindow* parent, wxWindowID id, const wxString& title,
 	miExport = new wxMenuItem( miFile, wxID_EXPORT, wxString( _("&Export") ) , wxEmptyString, wxITEM_NORMAL );
 	miFile->Append( miExport );
 	
+	wxMenuItem* miUpdateDict;
+	miUpdateDict = new wxMenuItem( miFile, wxID_ANY, wxString( _("Apply dictionary &update...") ) , wxEmptyString, wxITEM_NORMAL );
+	miFile->Append( miUpdateDict );
+	
 	wxMenuItem* miSettings;
 	miSettings = new wxMenuItem( miFile, wxID_PREFERENCES, wxString( _("&Settings") ) , wxEmptyString, wxITEM_NORMAL );
 	miFile->Append( miSettings );
@@ -63,10 +67,11 @@ VMainFrame::VMainFrame( wxWindow* parent, wxWindowID id, const wxString& title,
 	wxBoxSizer* bSizer3;
 	bSizer3 = new wxBoxSizer( wxHORIZONTAL );
 	
-	bPreview = new wxStaticBitmap( this, wxID_ANY, wxNullBitmap, wxDefaultPosition, wxDefaultSize, 0 );
-	bPreview->Hide();
+	bPreview = new GridPreview( this, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxHSCROLL|wxVSCROLL );
+	bPreview->SetScrollRate( 5, 5 );
+	bPreview->SetMinSize( wxSize( 400,300 ) );
 	
-	bSizer3->Add( bPreview, 0, wxBOTTOM|wxLEFT|wxRIGHT|wxTOP, 5 );
+	bSizer3->Add( bPreview, 1, wxBOTTOM|wxEXPAND|wxLEFT|wxRIGHT|wxTOP, 5 );
 	
 	tOutput = new wxTextCtrl( this, wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize, wxTE_MULTILINE|wxTE_READONLY|wxTE_WORDWRAP );
 	bSizer3->Add( tOutput, 1, wxALL|wxEXPAND, 5 );
@@ -76,9 +81,19 @@ VMainFrame::VMainFrame( wxWindow* parent, wxWindowID id, const wxString& title,
 	wxBoxSizer* bSizer5;
 	bSizer5 = new wxBoxSizer( wxHORIZONTAL );
 	
+	gLoading = new wxGauge( this, wxID_ANY, 100, wxDefaultPosition, wxSize( 150,-1 ), wxGA_HORIZONTAL );
+	gLoading->Hide();
+	
+	bSizer5->Add( gLoading, 0, wxALIGN_CENTER_VERTICAL|wxBOTTOM|wxLEFT, 5 );
+	
 	
 	bSizer5->Add( 0, 0, 1, wxEXPAND, 5 );
 	
+	bCancel = new wxButton( this, wxID_ANY, _("Cancel"), wxDefaultPosition, wxDefaultSize, 0 );
+	bCancel->Enable( false );
+	
+	bSizer5->Add( bCancel, 0, wxBOTTOM|wxRIGHT, 5 );
+	
 	bGenerate = new wxButton( this, wxID_ANY, _("Generate"), wxDefaultPosition, wxDefaultSize, 0 );
 	bSizer5->Add( bGenerate, 0, wxBOTTOM|wxRIGHT, 5 );
 	
@@ -86,16 +101,19 @@ VMainFrame::VMainFrame( wxWindow* parent, wxWindowID id, const wxString& title,
 	
 	this->SetSizer( bSizer2 );
 	this->Layout();
+	sbMain = this->CreateStatusBar( 1, wxST_SIZEGRIP, wxID_ANY );
 	
 	// Connect Events
 	this->Connect( wxEVT_CLOSE_WINDOW, wxCloseEventHandler( VMainFrame::onWindowClose ) );
 	this->Connect( miOpenGrid->GetId(), wxEVT_COMMAND_MENU_SELECTED, wxCommandEventHandler( VMainFrame::onOpenGridClick ) );
 	this->Connect( miGenerate->GetId(), wxEVT_COMMAND_MENU_SELECTED, wxCommandEventHandler( VMainFrame::onGenerateClick ) );
 	this->Connect( miExport->GetId(), wxEVT_COMMAND_MENU_SELECTED, wxCommandEventHandler( VMainFrame::onExportClick ) );
+	this->Connect( miUpdateDict->GetId(), wxEVT_COMMAND_MENU_SELECTED, wxCommandEventHandler( VMainFrame::onUpdateDictClick ) );
 	this->Connect( miSettings->GetId(), wxEVT_COMMAND_MENU_SELECTED, wxCommandEventHandler( VMainFrame::onSettingsClick ) );
 	this->Connect( miExit->GetId(), wxEVT_COMMAND_MENU_SELECTED, wxCommandEventHandler( VMainFrame::onExitClick ) );
 	this->Connect( miAbout->GetId(), wxEVT_COMMAND_MENU_SELECTED, wxCommandEventHandler( VMainFrame::onAboutClick ) );
 	bPath->Connect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( VMainFrame::onOpenGridClick ), NULL, this );
+	bCancel->Connect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( VMainFrame::onCancelClick ), NULL, this );
 	bGenerate->Connect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( VMainFrame::onGenerateClick ), NULL, this );
 }
 
@@ -106,10 +124,12 @@ VMainFrame::~VMainFrame()
 	this->Disconnect( wxID_ANY, wxEVT_COMMAND_MENU_SELECTED, wxCommandEventHandler( VMainFrame::onOpenGridClick ) );
 	this->Disconnect( wxID_ANY, wxEVT_COMMAND_MENU_SELECTED, wxCommandEventHandler( VMainFrame::onGenerateClick ) );
 	this->Disconnect( wxID_ANY, wxEVT_COMMAND_MENU_SELECTED, wxCommandEventHandler( VMainFrame::onExportClick ) );
+	this->Disconnect( wxID_ANY, wxEVT_COMMAND_MENU_SELECTED, wxCommandEventHandler( VMainFrame::onUpdateDictClick ) );
 	this->Disconnect( wxID_ANY, wxEVT_COMMAND_MENU_SELECTED, wxCommandEventHandler( VMainFrame::onSettingsClick ) );
 	this->Disconnect( wxID_ANY, wxEVT_COMMAND_MENU_SELECTED, wxCommandEventHandler( VMainFrame::onExitClick ) );
 	this->Disconnect( wxID_ANY, wxEVT_COMMAND_MENU_SELECTED, wxCommandEventHandler( VMainFrame::onAboutClick ) );
 	bPath->Disconnect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( VMainFrame::onOpenGridClick ), NULL, this );
+	bCancel->Disconnect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( VMainFrame::onCancelClick ), NULL, this );
 	bGenerate->Disconnect( wxEVT_COMMAND_BUTTON_CLICKED, wxCommandEventHandler( VMainFrame::onGenerateClick ), NULL, this );
 }
 
@@ -9,6 +9,7 @@
 #define __fbgui__
 
 #include <wx/intl.h>
+#include "gridpreview.hpp"
 
 #include <wx/string.h>
 #include <wx/bitmap.h>
@@ -22,7 +23,8 @@
 #include <wx/textctrl.h>
 #include <wx/button.h>
 #include <wx/sizer.h>
-#include <wx/statbmp.h>
+#include <wx/statusbr.h>
+#include <wx/gauge.h>
 #include <wx/frame.h>
 #include <wx/stattext.h>
 #include <wx/dialog.h>
@@ -45,16 +47,21 @@ class VMainFrame : public wxFrame
 		wxMenu* miHelp;
 		wxTextCtrl* tPath;
 		wxButton* bPath;
-		wxStaticBitmap* bPreview;
+		GridPreview* bPreview;
 		wxTextCtrl* tOutput;
+		wxGauge* gLoading;
 		
+		wxButton* bCancel;
 		wxButton* bGenerate;
+		wxStatusBar* sbMain;
 		
 		// Virtual event handlers, overide them in your derived class
 		virtual void onWindowClose( wxCloseEvent& event ) { event.Skip(); }
 		virtual void onOpenGridClick( wxCommandEvent& event ) { event.Skip(); }
 		virtual void onGenerateClick( wxCommandEvent& event ) { event.Skip(); }
+		virtual void onCancelClick( wxCommandEvent& event ) { event.Skip(); }
 		virtual void onExportClick( wxCommandEvent& event ) { event.Skip(); }
+		virtual void onUpdateDictClick( wxCommandEvent& event ) { event.Skip(); }
 		virtual void onSettingsClick( wxCommandEvent& event ) { event.Skip(); }
 		virtual void onExitClick( wxCommandEvent& event ) { event.Skip(); }
 		virtual void onAboutClick( wxCommandEvent& event ) { event.Skip(); }
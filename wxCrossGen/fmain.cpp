@@ -1,27 +1,131 @@
 #include "fmain.hpp"
 
+#include <chrono>
 
-MainFrame::MainFrame( wxWindow* parent): VMainFrame(parent) {
+DEFINE_EVENT_TYPE(wxEVT_GENERATE_PROGRESS)
+DEFINE_EVENT_TYPE(wxEVT_GENERATE_DONE)
+DEFINE_EVENT_TYPE(wxEVT_DICT_LOADED)
+
+MainFrame::MainFrame( wxWindow* parent): VMainFrame(parent), _loadTimer(this) {
     // Hack for better background
     #ifdef __WINDOWS__
     SetBackgroundColour(wxSystemSettings::GetColour(wxSYS_COLOUR_BTNFACE));
     #endif
-    _isDictLoaded = false;
+    _loadingOk       = false;
+    _loadingIsDelta  = false;
+    _isDictLoading   = false;
+    _dictId          = 0;
+    _pendingGenerate = false;
+    _isGenerating  = false;
+    _genId         = 0;
+    _genWordsCount = 0;
+    // Automatons are always built here, so candidates are ordered by lookahead
+    _genControl.lookahead = 16;
     srand(time(NULL));
     auto *config = wxConfigBase::Get();
     wxSize sz;
     sz.SetHeight(config->Read(SETTINGS_KEY_FMAIN_HEIGHT, SETTINGS_DEFAULT_FMAIN_HEIGHT));
     sz.SetWidth(config->Read(SETTINGS_KEY_FMAIN_WIDTH, SETTINGS_DEFAULT_FMAIN_WIDTH));
     SetSize(sz);
+    
+    Connect(wxID_ANY, wxEVT_GENERATE_PROGRESS, wxCommandEventHandler(MainFrame::onGenerateProgress));
+    Connect(wxID_ANY, wxEVT_GENERATE_DONE, wxCommandEventHandler(MainFrame::onGenerateDone));
+    Connect(wxID_ANY, wxEVT_DICT_LOADED, wxCommandEventHandler(MainFrame::onDictLoaded));
+    Connect(_loadTimer.GetId(), wxEVT_TIMER, wxTimerEventHandler(MainFrame::onLoadTimer));
+    
+    procDict(config->Read(SETTINGS_KEY_DICT_PATH, SETTINGS_DEFAULT_DICTPATH));
+}
+
+MainFrame::~MainFrame() {
+    stopGeneration();
+    if ( _dictThread.joinable() )
+        _dictThread.join();
 }
 
 void MainFrame::procDict(wxString path){
-    _dict.clear();
-    _allWords.clear();
-    _transType.clear();
-    readDict(path, _dict);
-    generateAllWords(_dict, _allWords, _transType);
-    _isDictLoaded = true;
+    if ( _isDictLoading ) {
+        // Loading cannot be interrupted, so the newest path waits for it
+        _pendingDictPath = path;
+        return;
+    }
+    startDictLoading(path, nullptr);
+}
+
+void MainFrame::startDictLoading(wxString path, std::shared_ptr<const PreparedDict> base){
+    _isDictLoading = true;
+    _pendingDictPath.Clear();
+    _loadingDict    = std::make_shared<PreparedDict>();
+    _loadingPath    = path;
+    _loadingOk      = false;
+    _loadingIsDelta = static_cast<bool>(base);
+    ++_dictId;
+    
+    gLoading->Show();
+    gLoading->Pulse();
+    _loadTimer.Start(100);
+    sbMain->SetStatusText(base ? _("Updating dictionary...") : _("Loading dictionary..."));
+    Layout();
+    
+    const unsigned int dict_id = _dictId;
+    const std::string  std_path = toStdPath(path);
+    _dictThread = std::thread([this, dict_id, std_path, base]() {
+        setTraceThreadName("dictionary loading");
+        try {
+            if ( base ) {
+                // Automatons of changed lengths are rebuilt by delta
+                _loadingOk = applyDictDelta(*base, std_path, *_loadingDict);
+            } else {
+                // Lengths are prepared by generation when grid needs them
+                _loadingOk = loadDict(std_path, *_loadingDict, true);
+                if ( _loadingOk )
+                    buildWordsDawgs(_loadingDict->words);
+            }
+        }
+        catch ( ... ) {
+            _loadingOk = false;
+        }
+        wxCommandEvent evt(wxEVT_DICT_LOADED);
+        evt.SetInt(dict_id);
+        wxPostEvent(this, evt);
+    });
+}
+
+void MainFrame::onDictLoaded(wxCommandEvent &event) {
+    if ( !_isDictLoading || (static_cast<unsigned int>(event.GetInt()) != _dictId) )
+        return;
+    if ( _dictThread.joinable() )
+        _dictThread.join();
+    _isDictLoading = false;
+    
+    if ( !_pendingDictPath.IsEmpty() ) {
+        procDict(_pendingDictPath);
+        return;
+    }
+    
+    _loadTimer.Stop();
+    gLoading->Hide();
+    Layout();
+    
+    // Running generation keeps its own pointer to old version of dictionary
+    if ( _loadingOk ) {
+        _dict = _loadingDict;
+        sbMain->SetStatusText(_loadingIsDelta ? _("Dictionary is updated") : _("Dictionary is loaded"));
+    } else {
+        sbMain->SetStatusText(wxEmptyString);
+        wxMessageBox((_loadingIsDelta ? _("Cannot apply dictionary update ") :
+            _("Cannot open dictionary file ")) + _loadingPath, _("Error"), wxICON_ERROR);
+    }
+    _loadingDict.reset();
+    
+    if ( _pendingGenerate ) {
+        _pendingGenerate = false;
+        if ( _dict && _grid && !_isGenerating )
+            startGeneration();
+    }
+}
+
+void MainFrame::onLoadTimer(wxTimerEvent &event) {
+    gLoading->Pulse();
 }
 
 void MainFrame::onOpenGridClick(wxCommandEvent &event) {
@@ -35,132 +139,157 @@ void MainFrame::onOpenGridClick(wxCommandEvent &event) {
         wxMessageBox(_("Cannot open file ") + dlgOpen.GetPath(), _("Error"), wxICON_ERROR );
         return;
     }
+    stopGeneration();
     tPath->SetValue(dlgOpen.GetPath());
     
     // Clearing
-    _grid.clear();
+    _grid.reset();
     _ques.clear();
     _ans.clear();
     tOutput->Clear();
+    bPreview->clear();
     
-    readGrid(tPath->GetValue(), _grid);
+    auto cgrid = std::make_shared<CompiledGrid>();
+    if ( !readGrid(toStdPath(tPath->GetValue()), *cgrid) ) {
+        wxMessageBox(_("Cannot open file ") + tPath->GetValue(), _("Error"), wxICON_ERROR );
+        return;
+    }
+    _grid = cgrid;
     
-    SetGridImage(_grid);
+    bPreview->setGrid(_grid);
+    GetSizer()->Layout();
 }
 
-void MainFrame::SetGridImage(GridType &grid, size_t w) {
-    size_t h = static_cast<float>(w) / grid.size() * grid.at(0).size();
-    wxBitmap bmp(w, h);
-    wxMemoryDC dc;
-    dc.SelectObject(bmp);
-    dc.Clear();
-    
-    std::vector<WordInfo> winfos;
-    generateWordInfo(grid, winfos);
-    
-    float sq_w = static_cast<int>(static_cast<float>(w) / grid.size());
-    float sq_h = static_cast<int>(static_cast<float>(h) / grid.at(0).size());
-    
-    wxFont cur_f = dc.GetFont();
-    cur_f.SetPointSize(sq_h/3);
-    
-    dc.SetBrush(wxBrush(wxColour(217,231,200)));
-    dc.SetFont(cur_f);
-    
-    for (size_t i = 0; i < grid.size(); ++i){
-        for (size_t j = 0; j < grid.at(0).size(); ++j){
-            if ( grid.at(i).at(j) == CELL_CLEAR )
-                dc.DrawRectangle(sq_w*i,sq_h*j,sq_w+1,sq_h+1);
-        }
-    }
+void MainFrame::onGenerateClick(wxCommandEvent &event) {
+    if ( _isGenerating )
+        return;
     
-    for (size_t i = 0; i < winfos.size(); ++i) {
-        dc.DrawText(wxString::Format(wxT("%d"),winfos.at(i).ind), sq_w*winfos.at(i).x, sq_h*winfos.at(i).y);
+    if ( !_grid ){
+        wxMessageBox( _("Crossword grid isn't loaded!"), _("Warning"), wxICON_WARNING);
+        return;
     }
-    
-    if ( _ans.size() > 0 ) {
-        using std::vector;
-        vector< vector< bool > > usedCells(
-            grid.size(), 
-            vector<bool>(grid.at(0).size(), false)
-        );
-        cur_f = dc.GetFont();
-        cur_f.SetPointSize(sq_h*0.6);
-        dc.SetFont(cur_f);
-        for ( size_t i = 0; i < winfos.size(); ++i ) {
-            if ( winfos.at(i).direct == true ) {
-                for (size_t j = 0; j < winfos.at(i).len; ++j)
-                    if ( !usedCells.at(winfos.at(i).x+j).at(winfos.at(i).y) ) {
-                        dc.DrawText(
-                            _ans.at(i).at(j),
-                            sq_w*(winfos.at(i).x+j) + sq_w*0.24,
-                            sq_h*winfos.at(i).y
-                        );
-                        usedCells.at(winfos.at(i).x+j).at(winfos.at(i).y) = true;
-                    }
-            } else {
-                for (size_t j = 0; j < winfos.at(i).len; ++j)
-                    if ( !usedCells.at(winfos.at(i).x).at(winfos.at(i).y+j) ) {
-                        dc.DrawText(
-                            _ans.at(i).at(j),
-                            sq_w*winfos.at(i).x + sq_w*0.24,
-                            sq_h*(winfos.at(i).y+j)
-                        );
-                        usedCells.at(winfos.at(i).x).at(winfos.at(i).y+j) = true;
-                    }
-            }
-        }
+    if ( _isDictLoading || !_dict ) {
+        // Generation starts as soon as dictionary is loaded
+        _pendingGenerate = true;
+        if ( !_isDictLoading )
+            procDict(wxConfigBase::Get()->Read(SETTINGS_KEY_DICT_PATH, SETTINGS_DEFAULT_DICTPATH));
+        sbMain->SetStatusText(_("Waiting for dictionary..."));
+        return;
     }
+    startGeneration();
+}
+
+void MainFrame::startGeneration() {
+    ++_genId;
+    _genDict       = _dict;
+    _isGenerating  = true;
+    _genWordsCount = _grid->winfos.size();
+    _genResult.clear();
+    _genControl.reset();
     
-    bPreview->SetBitmap(bmp);
-    bPreview->Show();
+    const unsigned int gen_id = _genId;
+    auto last_post = std::chrono::steady_clock::now();
+    _genControl.on_progress = [this, gen_id, last_post](const GenerateControl &ctrl) mutable {
+        auto cur_time = std::chrono::steady_clock::now();
+        if ( cur_time - last_post < std::chrono::milliseconds(250) )
+            return;
+        last_post = cur_time;
+        wxCommandEvent evt(wxEVT_GENERATE_PROGRESS);
+        evt.SetInt(gen_id);
+        wxPostEvent(this, evt);
+    };
     
-    dc.SelectObject( wxNullBitmap );
+    bGenerate->Disable();
+    bCancel->Enable();
+    sbMain->SetStatusText(_("Generating..."));
+    _genWatch.Start();
     
-    this->Refresh();
-    this->GetSizer()->RecalcSizes();
+    // Worker keeps its own pointers: new dictionary can be loaded meanwhile,
+    // and grid stays alive until cancelled worker is joined by opening of other grid
+    std::shared_ptr<const CompiledGrid> grid = _grid;
+    std::shared_ptr<const PreparedDict> dict = _genDict;
+    _genThread = std::thread([this, grid, dict, gen_id]() {
+        setTraceThreadName("generation");
+        try {
+            prepareDictLengths(*dict, *grid);
+            generateCrossIds(*grid, dict->words, _genResult, &_genControl);
+        }
+        catch ( ... ) {
+            _genResult.clear();
+        }
+        wxCommandEvent evt(wxEVT_GENERATE_DONE);
+        evt.SetInt(gen_id);
+        wxPostEvent(this, evt);
+    });
 }
 
-void MainFrame::onGenerateClick(wxCommandEvent &event) {
-    auto config = wxConfigBase::Get();
-    if ( !_isDictLoaded ) {
-        procDict(config->Read(SETTINGS_KEY_DICT_PATH, SETTINGS_DEFAULT_DICTPATH));
-    }
+void MainFrame::stopGeneration() {
+    if ( !_isGenerating )
+        return;
+    _genControl.cancel = true;
+    if ( _genThread.joinable() )
+        _genThread.join();
+    _isGenerating = false;
+    bGenerate->Enable();
+    bCancel->Disable();
+    sbMain->SetStatusText(_("Generation is cancelled"));
+}
+
+void MainFrame::onCancelClick(wxCommandEvent &event) {
+    if ( _isGenerating )
+        _genControl.cancel = true;
+}
+
+void MainFrame::onGenerateProgress(wxCommandEvent &event) {
+    if ( !_isGenerating || (static_cast<unsigned int>(event.GetInt()) != _genId) )
+        return;
+    double nodes   = static_cast<double>(_genControl.nodes);
+    double elapsed = std::max(_genWatch.Time(), 1L);
+    sbMain->SetStatusText(wxString::Format(_("Generating: %.0f nodes/s, best depth %lu of %lu"),
+        nodes * 1000 / elapsed, static_cast<unsigned long>(_genControl.best_depth), 
+        static_cast<unsigned long>(_genWordsCount)));
+}
+
+void MainFrame::onGenerateDone(wxCommandEvent &event) {
+    if ( !_isGenerating || (static_cast<unsigned int>(event.GetInt()) != _genId) )
+        return;
+    if ( _genThread.joinable() )
+        _genThread.join();
+    _isGenerating = false;
+    bGenerate->Enable();
+    bCancel->Disable();
     
-    std::vector<wxString> words_out;
-    if ( _grid.empty() ){
-        wxMessageBox( _("Crossword grid isn't loaded!"), _("Warning"), wxICON_WARNING);
+    if ( _genControl.cancel ) {
+        sbMain->SetStatusText(_("Generation is cancelled"));
         return;
     }
+    sbMain->SetStatusText(wxString::Format(_("Generated in %ld ms"), _genWatch.Time()));
+    applyGeneration(_genResult);
+}
+
+void MainFrame::applyGeneration(const std::vector<WordUniq> &ids) {
     try {
-        generateCross(_grid, _allWords, _transType, words_out);
-        
-        _ans = words_out;
-        
-        std::vector<WordInfo> winfos;
-        generateWordInfo(_grid, winfos);
-        
-        if ( winfos.size() == 0 ) 
+        if ( !_grid || _grid->winfos.empty() || (ids.size() != _grid->winfos.size()) ) 
             throw 42;
         
+        getWordsByIds(_genDict->words, _genDict->trans, ids, _ans);
+        
         _ques.clear();
-        for (size_t i = 0; i < words_out.size(); ++i)
-            _ques.push_back(getRandInterval(
-                _dict.lower_bound(words_out.at(i)),
-                _dict.upper_bound(words_out.at(i))
-            )->second);
+        TraceScope trace("chooseClues");
+        for (size_t i = 0; i < ids.size(); ++i)
+            _ques.push_back(getRandClue(_genDict->clues, ids.at(i)));
         
         tOutput->Clear();
         
         FilledCrossword t_cross;
-        t_cross.words = winfos;
-        t_cross.grid  = _grid;
+        t_cross.words = _grid->winfos;
+        t_cross.grid  = _grid->grid;
         t_cross.ans   = _ans;
         t_cross.ques  = _ques;
         
-        tOutput->AppendText(getQuesString(t_cross));
+        tOutput->AppendText(toWx(getQuesString(t_cross, getTranslatedTitles())));
         
-        SetGridImage(_grid);
+        bPreview->setAnswers(_ans);
     }
     catch ( ... ){
         tOutput->Clear();
@@ -170,26 +299,44 @@ void MainFrame::onGenerateClick(wxCommandEvent &event) {
 }
 
 void MainFrame::onExportClick(wxCommandEvent& event) {
-    if ( _grid.empty() ) {
+    if ( !_grid ) {
         wxMessageBox( _("Grid isn't loaded now"), _("Info"), wxICON_WARNING );
         return;
     }
      wxFileDialog dlgSave(this, _("Exporting crossword"), wxEmptyString, wxEmptyString,
-        _("txt files (*.txt)|*.txt"), wxFD_SAVE|wxFD_OVERWRITE_PROMPT);
+        _("txt files (*.txt)|*.txt|JSON files (*.json)|*.json|SVG images (*.svg)|*.svg|PNG images (*.png)|*.png"),
+        wxFD_SAVE|wxFD_OVERWRITE_PROMPT);
     if ( dlgSave.ShowModal() == wxID_CANCEL )
         return;
+    // Order of formats is the same as in filter of dialog
+    static const ExportFormat formats[] = {ExportFormat::Text, ExportFormat::Json, ExportFormat::Svg,
+        ExportFormat::Png};
+    int filter_ind = dlgSave.GetFilterIndex();
+    ExportFormat format = (filter_ind >= 0) && (filter_ind < 4) ? formats[filter_ind] : ExportFormat::Text;
     FilledCrossword t_cross;
-    t_cross.grid = _grid;
-    t_cross.ans  = _ans;
-    t_cross.ques = _ques;
-    generateWordInfo(_grid, t_cross.words);
-    if ( !exportToFile(t_cross, dlgSave.GetPath()) ){
+    t_cross.grid  = _grid->grid;
+    t_cross.words = _grid->winfos;
+    t_cross.ans   = _ans;
+    t_cross.ques  = _ques;
+    if ( !exportToFile(t_cross, toStdPath(dlgSave.GetPath()), getTranslatedTitles(), format) ){
         wxLogError(_("Cannot save current contents to file '%s'."), dlgSave.GetPath().GetData());
         return;
     }
     wxLogDebug(wxT("Exporting to ") + dlgSave.GetPath() + wxT(" is complete"));
 }
 
+void MainFrame::onUpdateDictClick(wxCommandEvent &event) {
+    if ( _isDictLoading || !_dict ) {
+        wxMessageBox(_("Dictionary isn't loaded now"), _("Info"), wxICON_WARNING);
+        return;
+    }
+    wxFileDialog dlgOpen(this, _("Open dictionary update"), wxEmptyString, wxEmptyString,
+        _("Text files (*.txt)|*.txt|All files (*)|*"), wxFD_OPEN|wxFD_FILE_MUST_EXIST);
+    if ( dlgOpen.ShowModal() == wxID_CANCEL )
+        return;
+    startDictLoading(dlgOpen.GetPath(), _dict);
+}
+
 void MainFrame::onSettingsClick( wxCommandEvent& event ){
     SettingsDialog fSettings(this);
     auto *config = wxConfigBase::Get();
@@ -203,6 +350,7 @@ void MainFrame::onSettingsClick( wxCommandEvent& event ){
 }
 
 void MainFrame::onWindowClose( wxCloseEvent& event ){
+    stopGeneration();
     saveConfig();
     event.Skip();
 }
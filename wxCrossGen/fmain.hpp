@@ -4,6 +4,8 @@
 
 #include <ctime>
 #include <map>
+#include <memory>
+#include <thread>
 #include <wx/wx.h>
 #include <wx/image.h>
 #include <wx/intl.h>
@@ -15,32 +17,76 @@
 #include "settingsconsts.hpp"
 #include "crossgen.hpp"
 #include "crossexport.hpp"
+#include "crosstrace.hpp"
+#include "crosswx.hpp"
 #include "fsettings.hpp"
 
 #ifndef APP_CATALOG
 #define APP_CATALOG "CrossGen"
 #endif
 
+// Events from generating thread, GetInt() is an id of generation
+DECLARE_EVENT_TYPE(wxEVT_GENERATE_PROGRESS, -1)
+DECLARE_EVENT_TYPE(wxEVT_GENERATE_DONE, -1)
+// Event from dictionary loading thread, GetInt() is an id of loading
+DECLARE_EVENT_TYPE(wxEVT_DICT_LOADED, -1)
+
 
 class MainFrame: public VMainFrame {
 protected:
-    std::vector<wxString> _ans;
-    std::vector<wxString> _ques;
-    DictType              _dict;
-    bool                  _isDictLoaded;
-    AllWordsType          _allWords;
-    CharsTransType        _transType;
-    GridType              _grid;
+    std::vector<std::u32string> _ans;
+    std::vector<std::u32string> _ques;
+    // Grid is compiled once on opening and shared with preview and generation
+    std::shared_ptr<const CompiledGrid> _grid;
+    
+    // Current dictionary, nullptr until first loading is finished. Every
+    // generation keeps its own pointer, so dictionary can be switched anytime
+    std::shared_ptr<const PreparedDict> _dict;
+    
+    // Dictionary is loaded in _dictThread, it is applied in onDictLoaded
+    std::thread                   _dictThread;
+    std::shared_ptr<PreparedDict> _loadingDict;
+    wxString                      _loadingPath;
+    bool                          _loadingOk;
+    bool                          _loadingIsDelta;  // delta is applied to _dict
+    bool                          _isDictLoading;
+    unsigned int                  _dictId;
+    wxString                      _pendingDictPath; // is loaded after current one
+    bool                          _pendingGenerate; // Generate was clicked while loading
+    wxTimer                       _loadTimer;       // animates gLoading
+    
+    // Generation runs in _genThread, results are applied in onGenerateDone
+    std::shared_ptr<const PreparedDict> _genDict;
+    std::thread                 _genThread;
+    GenerateControl             _genControl;
+    std::vector<WordUniq>       _genResult;
+    bool                        _isGenerating;
+    unsigned int                _genId;
+    size_t                      _genWordsCount;
+    wxStopWatch                 _genWatch;
+    
+    // Loads dictionary from path or applies delta from path to base if it isn't nullptr
+    void startDictLoading(wxString path, std::shared_ptr<const PreparedDict> base);
+    void startGeneration();
+    void stopGeneration();
+    void applyGeneration(const std::vector<WordUniq> &ids);
 
 public:
-    void SetGridImage(GridType &grid, size_t w=400);
+    // Starts loading of dictionary in background
     void procDict(wxString path);
     void saveConfig();
     
     MainFrame( wxWindow* parent);
+    ~MainFrame();
     void onWindowClose( wxCloseEvent& event );
     void onOpenGridClick( wxCommandEvent& event );
     void onGenerateClick( wxCommandEvent& event );
+    void onCancelClick( wxCommandEvent& event );
+    void onGenerateProgress( wxCommandEvent& event );
+    void onGenerateDone( wxCommandEvent& event );
+    void onDictLoaded( wxCommandEvent& event );
+    void onLoadTimer( wxTimerEvent& event );
+    void onUpdateDictClick( wxCommandEvent& event );
     void onSettingsClick( wxCommandEvent& event );
     void onExportClick( wxCommandEvent& event );
     void onExitClick( wxCommandEvent& event );
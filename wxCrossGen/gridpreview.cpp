@@ -0,0 +1,233 @@
+#include "gridpreview.hpp"
+
+#include <algorithm>
+
+#include "crosswx.hpp"
+
+GridPreview::GridPreview(wxWindow *parent, wxWindowID id, const wxPoint &pos,
+        const wxSize &size, long style): wxScrolledWindow(parent, id, pos, size, style),
+        _zoomTimer(this) {
+    _layerCellSize = 0;
+    _cellSize      = 0;
+    SetBackgroundColour(*wxWHITE);
+    Connect(wxEVT_PAINT, wxPaintEventHandler(GridPreview::onPaint));
+    Connect(wxEVT_ERASE_BACKGROUND, wxEraseEventHandler(GridPreview::onEraseBackground));
+    Connect(wxEVT_MOUSEWHEEL, wxMouseEventHandler(GridPreview::onMouseWheel));
+    Connect(wxEVT_LEFT_DOWN, wxMouseEventHandler(GridPreview::onLeftDown));
+    Connect(wxEVT_LEFT_UP, wxMouseEventHandler(GridPreview::onLeftUp));
+    Connect(wxEVT_MOTION, wxMouseEventHandler(GridPreview::onMotion));
+    Connect(wxEVT_MOUSE_CAPTURE_LOST, wxMouseCaptureLostEventHandler(GridPreview::onCaptureLost));
+    Connect(_zoomTimer.GetId(), wxEVT_TIMER, wxTimerEventHandler(GridPreview::onZoomTimer));
+}
+
+GridPreview::~GridPreview() {
+    _zoomTimer.Stop();
+    if ( HasCapture() )
+        ReleaseMouse();
+}
+
+void GridPreview::setGrid(std::shared_ptr<const CompiledGrid> grid) {
+    _grid = grid;
+    _letters.clear();
+    if ( _grid ) {
+        _cellSize = std::max(DEFAULT_WIDTH / static_cast<int>(_grid->width), 1);
+        _cellSize = std::min(std::max(_cellSize, MIN_CELL_SIZE), getMaxCellSize());
+    }
+    _zoomTimer.Stop();
+    rebuildStaticLayer();
+    updateVirtualSize();
+    Scroll(0, 0);
+    Refresh();
+}
+
+void GridPreview::setAnswers(const std::vector<std::u32string> &ans) {
+    _letters.clear();
+    if ( _grid && (ans.size() == _grid->winfos.size()) && !ans.empty() ) {
+        _letters.assign(_grid->width, std::vector<char32_t>(_grid->height, 0));
+        for (size_t i = 0; i < _grid->winfos.size(); ++i) {
+            const WordInfo &wi = _grid->winfos.at(i);
+            for (size_t j = 0; j < wi.len; ++j) {
+                if ( wi.direct )
+                    _letters.at(wi.x + j).at(wi.y) = ans.at(i).at(j);
+                else
+                    _letters.at(wi.x).at(wi.y + j) = ans.at(i).at(j);
+            }
+        }
+    }
+    Refresh();
+}
+
+void GridPreview::clear() {
+    setGrid(nullptr);
+}
+
+int GridPreview::getMaxCellSize() const {
+    if ( !_grid )
+        return MAX_CELL_SIZE;
+    int max_side = static_cast<int>(std::max(_grid->width, _grid->height));
+    return std::max(std::min(MAX_CELL_SIZE, MAX_LAYER_SIZE / max_side), MIN_CELL_SIZE);
+}
+
+void GridPreview::setCellSize(int cell_size) {
+    applyCellSize(cell_size);
+    if ( _layerCellSize != _cellSize ) {
+        _zoomTimer.Stop();
+        rebuildStaticLayer();
+    }
+}
+
+void GridPreview::applyCellSize(int cell_size) {
+    cell_size = std::min(std::max(cell_size, MIN_CELL_SIZE), getMaxCellSize());
+    if ( (cell_size == _cellSize) || !_grid )
+        return;
+
+    // Keeping cell under center of window on its place
+    wxSize  client = GetClientSize();
+    int     cx, cy;
+    CalcUnscrolledPosition(client.GetWidth() / 2, client.GetHeight() / 2, &cx, &cy);
+    double  ratio = static_cast<double>(cell_size) / _cellSize;
+
+    _cellSize = cell_size;
+    updateVirtualSize();
+
+    int step_x, step_y;
+    GetScrollPixelsPerUnit(&step_x, &step_y);
+    int new_x = static_cast<int>(cx * ratio) - client.GetWidth() / 2;
+    int new_y = static_cast<int>(cy * ratio) - client.GetHeight() / 2;
+    Scroll(std::max(new_x, 0) / std::max(step_x, 1), std::max(new_y, 0) / std::max(step_y, 1));
+    Refresh();
+}
+
+void GridPreview::updateVirtualSize() {
+    if ( !_grid ) {
+        SetVirtualSize(0, 0);
+        return;
+    }
+    SetScrollRate(std::max(_cellSize / 2, 1), std::max(_cellSize / 2, 1));
+    SetVirtualSize(_cellSize * _grid->width + 1, _cellSize * _grid->height + 1);
+}
+
+void GridPreview::rebuildStaticLayer() {
+    _layerCellSize = _cellSize;
+    if ( !_grid ) {
+        _staticLayer = wxNullBitmap;
+        return;
+    }
+    const int sq = _cellSize;
+    _staticLayer.Create(sq * _grid->width + 1, sq * _grid->height + 1);
+    wxMemoryDC dc;
+    dc.SelectObject(_staticLayer);
+    dc.SetBackground(*wxWHITE_BRUSH);
+    dc.Clear();
+
+    dc.SetBrush(wxBrush(wxColour(217,231,200)));
+    for (size_t i = 0; i < _grid->width; ++i){
+        for (size_t j = 0; j < _grid->height; ++j){
+            if ( _grid->grid.at(i).at(j) == CELL_CLEAR )
+                dc.DrawRectangle(sq*i, sq*j, sq+1, sq+1);
+        }
+    }
+
+    wxFont cur_f = dc.GetFont();
+    cur_f.SetPointSize(std::max(sq/3, 1));
+    dc.SetFont(cur_f);
+    const std::vector<WordInfo> &winfos = _grid->winfos;
+    for (size_t i = 0; i < winfos.size(); ++i) {
+        dc.DrawText(wxString::Format(wxT("%d"), static_cast<int>(winfos.at(i).ind)),
+            sq*winfos.at(i).x, sq*winfos.at(i).y);
+    }
+    dc.SelectObject(wxNullBitmap);
+}
+
+void GridPreview::onPaint(wxPaintEvent &event) {
+    wxPaintDC dc(this);
+    DoPrepareDC(dc);
+
+    // Visible area in grid coordinates
+    wxSize client = GetClientSize();
+    int    x0, y0;
+    CalcUnscrolledPosition(0, 0, &x0, &y0);
+
+    dc.SetBackground(wxBrush(GetBackgroundColour()));
+    dc.Clear();
+    if ( !_grid || !_staticLayer.IsOk() )
+        return;
+
+    // Layer of other cell size is being zoomed, it is scaled till it is rebuilt
+    const double scale = static_cast<double>(_cellSize) / _layerCellSize;
+    int w = std::min(client.GetWidth(),  static_cast<int>(_staticLayer.GetWidth() * scale) - x0);
+    int h = std::min(client.GetHeight(), static_cast<int>(_staticLayer.GetHeight() * scale) - y0);
+    if ( (w > 0) && (h > 0) ) {
+        wxMemoryDC mem_dc;
+        mem_dc.SelectObject(_staticLayer);
+        if ( _layerCellSize == _cellSize ) {
+            dc.Blit(x0, y0, w, h, &mem_dc, x0, y0);
+        } else {
+            int src_x = std::min(static_cast<int>(x0 / scale), _staticLayer.GetWidth() - 1);
+            int src_y = std::min(static_cast<int>(y0 / scale), _staticLayer.GetHeight() - 1);
+            int src_w = std::min(std::max(static_cast<int>(w / scale), 1), _staticLayer.GetWidth() - src_x);
+            int src_h = std::min(std::max(static_cast<int>(h / scale), 1), _staticLayer.GetHeight() - src_y);
+            dc.StretchBlit(x0, y0, w, h, &mem_dc, src_x, src_y, src_w, src_h);
+        }
+        mem_dc.SelectObject(wxNullBitmap);
+    }
+
+    if ( _letters.empty() )
+        return;
+    const int sq = _cellSize;
+    wxFont cur_f = dc.GetFont();
+    cur_f.SetPointSize(std::max(static_cast<int>(sq*0.6), 1));
+    dc.SetFont(cur_f);
+    size_t i_from = x0 / sq;
+    size_t j_from = y0 / sq;
+    size_t i_to   = std::min<size_t>((x0 + client.GetWidth()) / sq + 1, _letters.size());
+    size_t j_to   = std::min<size_t>((y0 + client.GetHeight()) / sq + 1, _letters.at(0).size());
+    for (size_t i = i_from; i < i_to; ++i)
+        for (size_t j = j_from; j < j_to; ++j)
+            if ( _letters.at(i).at(j) != 0 )
+                dc.DrawText(toWx(_letters.at(i).at(j)), sq*i + sq*0.24, sq*j);
+}
+
+void GridPreview::onMouseWheel(wxMouseEvent &event) {
+    if ( !event.ControlDown() ) {
+        event.Skip();
+        return;
+    }
+    int new_size = event.GetWheelRotation() > 0 ?
+        std::max(_cellSize * 5 / 4, _cellSize + 1) :
+        std::min(_cellSize * 4 / 5, _cellSize - 1);
+    applyCellSize(new_size);
+    if ( _layerCellSize != _cellSize )
+        _zoomTimer.Start(ZOOM_REBUILD_DELAY, wxTIMER_ONE_SHOT);
+}
+
+void GridPreview::onZoomTimer(wxTimerEvent &event) {
+    rebuildStaticLayer();
+    Refresh();
+}
+
+void GridPreview::onLeftDown(wxMouseEvent &event) {
+    _dragStart = event.GetPosition();
+    if ( !HasCapture() )
+        CaptureMouse();
+}
+
+void GridPreview::onLeftUp(wxMouseEvent &event) {
+    if ( HasCapture() )
+        ReleaseMouse();
+}
+
+void GridPreview::onMotion(wxMouseEvent &event) {
+    if ( !event.Dragging() || !event.LeftIsDown() || !HasCapture() )
+        return;
+    int step_x, step_y, view_x, view_y;
+    GetScrollPixelsPerUnit(&step_x, &step_y);
+    GetViewStart(&view_x, &view_y);
+    wxPoint delta = _dragStart - event.GetPosition();
+    int units_x = step_x > 0 ? delta.x / step_x : 0;
+    int units_y = step_y > 0 ? delta.y / step_y : 0;
+    if ( (units_x == 0) && (units_y == 0) )
+        return;
+    Scroll(view_x + units_x, view_y + units_y);
+    _dragStart -= wxPoint(units_x * step_x, units_y * step_y);
+}
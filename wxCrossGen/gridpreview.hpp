@@ -0,0 +1,70 @@
+#ifndef GRIDPREVIEW_HPP
+#define GRIDPREVIEW_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <wx/wx.h>
+#include <wx/scrolwin.h>
+
+#include "crossgen.hpp"
+
+// Preview of crossword grid with zoom (Ctrl + wheel) and pan (scrolling or
+// dragging by left button).
+// Cells and slot numbers depend only on grid and zoom, so they are rasterized
+// once to _staticLayer. Answers are drawn over it for visible cells only, so
+// new fill or scrolling doesn't redraw whole grid.
+// While zooming the old layer is scaled, it is rebuilt once when wheel stops.
+class GridPreview: public wxScrolledWindow {
+protected:
+    std::shared_ptr<const CompiledGrid>  _grid;    // nullptr if there is no grid
+    std::vector< std::vector<char32_t> > _letters; // answers by cells, 0 is empty
+    wxBitmap                             _staticLayer;
+    int                                  _layerCellSize; // cell size of _staticLayer
+    int                                  _cellSize;
+    wxPoint                              _dragStart;
+    wxTimer                              _zoomTimer;     // rebuilds layer after zooming
+
+    // Changes cell size and scroll, layer isn't rebuilt
+    void applyCellSize(int cell_size);
+    void rebuildStaticLayer();
+    void updateVirtualSize();
+    int  getMaxCellSize() const;
+
+    void onPaint(wxPaintEvent &event);
+    void onEraseBackground(wxEraseEvent &event) {}
+    void onMouseWheel(wxMouseEvent &event);
+    void onLeftDown(wxMouseEvent &event);
+    void onLeftUp(wxMouseEvent &event);
+    void onMotion(wxMouseEvent &event);
+    void onCaptureLost(wxMouseCaptureLostEvent &event) {}
+    void onZoomTimer(wxTimerEvent &event);
+
+public:
+    // Default width of grid like old static preview
+    static const int DEFAULT_WIDTH = 400;
+    static const int MIN_CELL_SIZE = 4;
+    static const int MAX_CELL_SIZE = 96;
+    // Side of _staticLayer is limited to keep memory usage sane
+    static const int MAX_LAYER_SIZE = 4096;
+    // Milliseconds after the last wheel notch before layer is rebuilt
+    static const int ZOOM_REBUILD_DELAY = 200;
+
+    GridPreview(wxWindow *parent, wxWindowID id = wxID_ANY,
+        const wxPoint &pos = wxDefaultPosition, const wxSize &size = wxDefaultSize,
+        long style = wxHSCROLL|wxVSCROLL);
+    ~GridPreview();
+
+    // Rebuilds cached layers, answers are cleared
+    void setGrid(std::shared_ptr<const CompiledGrid> grid);
+    // Answers in order of generateWordInfo, empty vector clears them
+    void setAnswers(const std::vector<std::u32string> &ans);
+    void clear();
+
+    void setCellSize(int cell_size);
+    int  getCellSize() const {
+        return _cellSize;
+    }
+};
+
+#endif // GRIDPREVIEW_HPP
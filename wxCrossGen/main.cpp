@@ -1,40 +1,59 @@
-#include <wx/wx.h>
-#include <wx/fileconf.h>
-
-#include "fsettings.hpp"
-#include "fmain.hpp"
-
-class MyApp: public wxApp {
-public:
-    bool OnInit();
-protected:
-    wxLocale m_locale;  // locale we'll be using
-};
-
-IMPLEMENT_APP(MyApp)
-
-bool MyApp::OnInit()
-{
-    m_locale.Init();
-    wxLocale::AddCatalogLookupPathPrefix(wxT("."));
-#ifdef APP_LOCALE_DIR
-    m_locale.AddCatalogLookupPathPrefix(wxT(APP_LOCALE_DIR));
-#endif
-    m_locale.AddCatalog(wxT(APP_CATALOG));
-#ifdef __LINUX__
-    {
-        wxLogNull noLog;
-        m_locale.AddCatalog(wxT("fileutils"));
-    }
-#endif
-
-    SetAppName(wxT("CrossGen"));
-
-    wxInitAllImageHandlers();
-    wxConfigBase *config = new wxFileConfig;
-    wxConfigBase::Set(config);
-    MainFrame* fMain = new MainFrame(NULL);
-    SetTopWindow(fMain);
-    fMain->Show();
-    return true;
-}
+#include <wx/wx.h>
+#include <wx/fileconf.h>
+
+#include "fsettings.hpp"
+#include "fmain.hpp"
+
+class MyApp: public wxApp {
+public:
+    bool OnInit();
+    int OnExit();
+protected:
+    wxLocale m_locale;  // locale we'll be using
+    wxString m_tracePath; // timeline is written here on exit if it isn't empty
+};
+
+IMPLEMENT_APP(MyApp)
+
+bool MyApp::OnInit()
+{
+    m_locale.Init();
+    wxLocale::AddCatalogLookupPathPrefix(wxT("."));
+#ifdef APP_LOCALE_DIR
+    m_locale.AddCatalogLookupPathPrefix(wxT(APP_LOCALE_DIR));
+#endif
+    m_locale.AddCatalog(wxT(APP_CATALOG));
+#ifdef __LINUX__
+    {
+        wxLogNull noLog;
+        m_locale.AddCatalog(wxT("fileutils"));
+    }
+#endif
+
+    SetAppName(wxT("CrossGen"));
+    
+    // --trace=<file> writes timeline of phases in Chrome trace format
+    for (int i = 1; i < argc; ++i) {
+        wxString arg = argv[i];
+        if ( arg.StartsWith(wxT("--trace="), &m_tracePath) ) {
+            enableTrace(true);
+            setTraceThreadName("main");
+        }
+    }
+
+    wxInitAllImageHandlers();
+    wxConfigBase *config = new wxFileConfig;
+    wxConfigBase::Set(config);
+    MainFrame* fMain = new MainFrame(NULL);
+    SetTopWindow(fMain);
+    fMain->Show();
+    return true;
+}
+
+int MyApp::OnExit()
+{
+    // Frame is destroyed and its threads are joined, so no one records events
+    if ( !m_tracePath.empty() )
+        writeTrace(toStdPath(m_tracePath));
+    return wxApp::OnExit();
+}
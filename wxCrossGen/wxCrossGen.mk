@@ -60,7 +60,7 @@ AS       := /usr/bin/as
 ## User defined environment variables
 ##
 CodeLiteDir:=/usr/share/codelite
-Objects0=$(IntermediateDirectory)/main.cpp$(ObjectSuffix) $(IntermediateDirectory)/fmain.cpp$(ObjectSuffix) $(IntermediateDirectory)/fsettings.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_crossexport.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_crossgen.cpp$(ObjectSuffix) $(IntermediateDirectory)/fbgui_fbgui.cpp$(ObjectSuffix) 
+Objects0=$(IntermediateDirectory)/main.cpp$(ObjectSuffix) $(IntermediateDirectory)/fmain.cpp$(ObjectSuffix) $(IntermediateDirectory)/fsettings.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_crossexport.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_crossgen.cpp$(ObjectSuffix) $(IntermediateDirectory)/fbgui_fbgui.cpp$(ObjectSuffix) $(IntermediateDirectory)/crosswx.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_crossutils.cpp$(ObjectSuffix) $(IntermediateDirectory)/gridpreview.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_crossdawg.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_crosslocal.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_crossgrid.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_crosstrace.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_crossanalyze.cpp$(ObjectSuffix) $(IntermediateDirectory)/src_crossimage.cpp$(ObjectSuffix) 
 
 
 
@@ -135,6 +135,78 @@ $(IntermediateDirectory)/fbgui_fbgui.cpp$(DependSuffix): fbgui/fbgui.cpp
 $(IntermediateDirectory)/fbgui_fbgui.cpp$(PreprocessSuffix): fbgui/fbgui.cpp
 	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/fbgui_fbgui.cpp$(PreprocessSuffix) "fbgui/fbgui.cpp"
 
+$(IntermediateDirectory)/crosswx.cpp$(ObjectSuffix): crosswx.cpp $(IntermediateDirectory)/crosswx.cpp$(DependSuffix)
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/data/Sync/SyncProjects/CrossGen/wxCrossGen/crosswx.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/crosswx.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/crosswx.cpp$(DependSuffix): crosswx.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/crosswx.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/crosswx.cpp$(DependSuffix) -MM "crosswx.cpp"
+
+$(IntermediateDirectory)/crosswx.cpp$(PreprocessSuffix): crosswx.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/crosswx.cpp$(PreprocessSuffix) "crosswx.cpp"
+
+$(IntermediateDirectory)/src_crossutils.cpp$(ObjectSuffix): ../src/crossutils.cpp $(IntermediateDirectory)/src_crossutils.cpp$(DependSuffix)
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/data/Sync/SyncProjects/CrossGen/src/crossutils.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_crossutils.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_crossutils.cpp$(DependSuffix): ../src/crossutils.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_crossutils.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_crossutils.cpp$(DependSuffix) -MM "../src/crossutils.cpp"
+
+$(IntermediateDirectory)/src_crossutils.cpp$(PreprocessSuffix): ../src/crossutils.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_crossutils.cpp$(PreprocessSuffix) "../src/crossutils.cpp"
+
+$(IntermediateDirectory)/gridpreview.cpp$(ObjectSuffix): gridpreview.cpp $(IntermediateDirectory)/gridpreview.cpp$(DependSuffix)
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/data/Sync/SyncProjects/CrossGen/wxCrossGen/gridpreview.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/gridpreview.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/gridpreview.cpp$(DependSuffix): gridpreview.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/gridpreview.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/gridpreview.cpp$(DependSuffix) -MM "gridpreview.cpp"
+
+$(IntermediateDirectory)/gridpreview.cpp$(PreprocessSuffix): gridpreview.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/gridpreview.cpp$(PreprocessSuffix) "gridpreview.cpp"
+
+$(IntermediateDirectory)/src_crossdawg.cpp$(ObjectSuffix): ../src/crossdawg.cpp $(IntermediateDirectory)/src_crossdawg.cpp$(DependSuffix)
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/data/Sync/SyncProjects/CrossGen/src/crossdawg.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_crossdawg.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_crossdawg.cpp$(DependSuffix): ../src/crossdawg.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_crossdawg.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_crossdawg.cpp$(DependSuffix) -MM "../src/crossdawg.cpp"
+
+$(IntermediateDirectory)/src_crossdawg.cpp$(PreprocessSuffix): ../src/crossdawg.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_crossdawg.cpp$(PreprocessSuffix) "../src/crossdawg.cpp"
+
+$(IntermediateDirectory)/src_crosslocal.cpp$(ObjectSuffix): ../src/crosslocal.cpp $(IntermediateDirectory)/src_crosslocal.cpp$(DependSuffix)
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/data/Sync/SyncProjects/CrossGen/src/crosslocal.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_crosslocal.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_crosslocal.cpp$(DependSuffix): ../src/crosslocal.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_crosslocal.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_crosslocal.cpp$(DependSuffix) -MM "../src/crosslocal.cpp"
+
+$(IntermediateDirectory)/src_crosslocal.cpp$(PreprocessSuffix): ../src/crosslocal.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_crosslocal.cpp$(PreprocessSuffix) "../src/crosslocal.cpp"
+
+$(IntermediateDirectory)/src_crossgrid.cpp$(ObjectSuffix): ../src/crossgrid.cpp $(IntermediateDirectory)/src_crossgrid.cpp$(DependSuffix)
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/data/Sync/SyncProjects/CrossGen/src/crossgrid.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_crossgrid.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_crossgrid.cpp$(DependSuffix): ../src/crossgrid.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_crossgrid.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_crossgrid.cpp$(DependSuffix) -MM "../src/crossgrid.cpp"
+
+$(IntermediateDirectory)/src_crossgrid.cpp$(PreprocessSuffix): ../src/crossgrid.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_crossgrid.cpp$(PreprocessSuffix) "../src/crossgrid.cpp"
+
+$(IntermediateDirectory)/src_crosstrace.cpp$(ObjectSuffix): ../src/crosstrace.cpp $(IntermediateDirectory)/src_crosstrace.cpp$(DependSuffix)
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/data/Sync/SyncProjects/CrossGen/src/crosstrace.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_crosstrace.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_crosstrace.cpp$(DependSuffix): ../src/crosstrace.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_crosstrace.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_crosstrace.cpp$(DependSuffix) -MM "../src/crosstrace.cpp"
+
+$(IntermediateDirectory)/src_crosstrace.cpp$(PreprocessSuffix): ../src/crosstrace.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_crosstrace.cpp$(PreprocessSuffix) "../src/crosstrace.cpp"
+
+$(IntermediateDirectory)/src_crossanalyze.cpp$(ObjectSuffix): ../src/crossanalyze.cpp $(IntermediateDirectory)/src_crossanalyze.cpp$(DependSuffix)
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/data/Sync/SyncProjects/CrossGen/src/crossanalyze.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_crossanalyze.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_crossanalyze.cpp$(DependSuffix): ../src/crossanalyze.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_crossanalyze.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_crossanalyze.cpp$(DependSuffix) -MM "../src/crossanalyze.cpp"
+
+$(IntermediateDirectory)/src_crossanalyze.cpp$(PreprocessSuffix): ../src/crossanalyze.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_crossanalyze.cpp$(PreprocessSuffix) "../src/crossanalyze.cpp"
+
+$(IntermediateDirectory)/src_crossimage.cpp$(ObjectSuffix): ../src/crossimage.cpp $(IntermediateDirectory)/src_crossimage.cpp$(DependSuffix)
+	$(CXX) $(IncludePCH) $(SourceSwitch) "/data/Sync/SyncProjects/CrossGen/src/crossimage.cpp" $(CXXFLAGS) $(ObjectSwitch)$(IntermediateDirectory)/src_crossimage.cpp$(ObjectSuffix) $(IncludePath)
+$(IntermediateDirectory)/src_crossimage.cpp$(DependSuffix): ../src/crossimage.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) -MG -MP -MT$(IntermediateDirectory)/src_crossimage.cpp$(ObjectSuffix) -MF$(IntermediateDirectory)/src_crossimage.cpp$(DependSuffix) -MM "../src/crossimage.cpp"
+
+$(IntermediateDirectory)/src_crossimage.cpp$(PreprocessSuffix): ../src/crossimage.cpp
+	@$(CXX) $(CXXFLAGS) $(IncludePCH) $(IncludePath) $(PreprocessOnlySwitch) $(OutputSwitch) $(IntermediateDirectory)/src_crossimage.cpp$(PreprocessSuffix) "../src/crossimage.cpp"
+
 
 -include $(IntermediateDirectory)/*$(DependSuffix)
 ##